@@ -0,0 +1,124 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_BENCHMARKS_BENCHMARK_H
+#define LSST_MODELFIT_PARAMETERS_BENCHMARKS_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace lsst::modelfit::parameters::benchmarks {
+
+/// The result of timing one operation for a given number of parameters
+struct Result {
+    std::string name;
+    std::string path;
+    size_t n_parameters;
+    size_t n_repeats;
+    double ns_per_op;
+};
+
+/**
+ * A minimal timer for repeated passes over a set of parameters.
+ *
+ * Passes are repeated until their total elapsed time exceeds a minimum,
+ * and the mean time per operation (i.e. per parameter) is recorded.
+ */
+class Runner {
+private:
+    std::vector<Result> _results;
+    double _time_min;
+
+public:
+    /// A sink to prevent results of benchmarked calls from being discarded
+    volatile double sink = 0;
+
+    /**
+     * Time a function performing one pass over n_parameters parameters.
+     *
+     * @param name The name of the operation.
+     * @param path The call path, e.g. virtual or concrete.
+     * @param n_parameters The number of parameters (operations) per pass.
+     * @param func The function performing a single pass.
+     */
+    template <typename F>
+    void run(std::string name, std::string path, size_t n_parameters, F&& func) {
+        using clock = std::chrono::steady_clock;
+        func();
+        // Double the number of passes per timing until it takes long enough,
+        // so that clock overhead is negligible for small n_parameters
+        size_t n_repeats = 1;
+        double elapsed = 0;
+        while (true) {
+            const auto start = clock::now();
+            for (size_t repeat = 0; repeat < n_repeats; ++repeat) func();
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            if (elapsed >= _time_min) break;
+            n_repeats *= 2;
+        }
+        _results.push_back({std::move(name), std::move(path), n_parameters, n_repeats,
+                            1e9 * elapsed / (n_repeats * n_parameters)});
+    }
+
+    /// Return all results so far
+    const std::vector<Result>& get_results() const { return _results; }
+
+    /// Write all results so far as a JSON object
+    void write_json(std::ostream& out) const {
+        out << "{\n  \"benchmarks\": [";
+        for (size_t idx = 0; idx < _results.size(); ++idx) {
+            const auto& result = _results[idx];
+            out << (idx ? ",\n" : "\n") << "    {\"name\": \"" << result.name << "\", \"path\": \""
+                << result.path << "\", \"n_parameters\": " << result.n_parameters
+                << ", \"n_repeats\": " << result.n_repeats << ", \"ns_per_op\": " << result.ns_per_op << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    /// Write results to the file named by the first argument, else stdout
+    int write_json(int argc, char** argv) const {
+        if (argc > 1) {
+            std::ofstream file(argv[1]);
+            if (!file) {
+                std::cerr << "Failed to open " << argv[1] << " for writing" << std::endl;
+                return 1;
+            }
+            write_json(file);
+        } else {
+            write_json(std::cout);
+        }
+        return 0;
+    }
+
+    /// Initialize a Runner with a minimum total time (in seconds) per result
+    explicit Runner(double time_min = 0.02) : _time_min(time_min) {}
+};
+
+}  // namespace lsst::modelfit::parameters::benchmarks
+
+#endif  // LSST_MODELFIT_PARAMETERS_BENCHMARKS_BENCHMARK_H
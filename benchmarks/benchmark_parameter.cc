@@ -0,0 +1,197 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "benchmark.h"
+#include "lsst/modelfit/parameters/parameter_set.h"
+#include "lsst/modelfit/parameters/sampler.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+namespace bench = lsst::modelfit::parameters::benchmarks;
+
+using Base = mod_params::ParameterBase<double>;
+using Real = mod_params::RealParameter;
+using Positive = mod_params::PositiveParameter;
+using Log = mod_params::LogTransform<double>;
+
+/*
+ * Concrete calls are qualified (e.g. param.Real::set_value), which bypasses
+ * virtual dispatch as a call to a final CRTP class would.
+ */
+void run_size(bench::Runner& runner, size_t n) {
+    auto transform_log = std::make_shared<Log>();
+    auto limits = std::make_shared<mod_params::Limits<double>>(-1., 1., "bench");
+    std::vector<std::shared_ptr<Real>> reals;
+    std::vector<std::shared_ptr<Positive>> positives;
+    std::vector<std::shared_ptr<Positive>> positives_exact;
+    std::vector<std::shared_ptr<Positive>> positives_lazy;
+    std::vector<Base*> reals_base;
+    std::vector<Base*> positives_base;
+    reals.reserve(n);
+    positives.reserve(n);
+    positives_exact.reserve(n);
+    positives_lazy.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        reals.emplace_back(std::make_shared<Real>(0., limits, nullptr, nullptr, false, "real"));
+        positives.emplace_back(std::make_shared<Positive>(1., nullptr, transform_log));
+        positives_exact.emplace_back(std::make_shared<Positive>(1., nullptr, transform_log));
+        positives_exact.back()->set_transformed_exact(true);
+        positives_lazy.emplace_back(std::make_shared<Positive>(1., nullptr, transform_log));
+        positives_lazy.back()->set_transformed_lazy(true);
+        reals_base.push_back(reals.back().get());
+        positives_base.push_back(positives.back().get());
+    }
+    std::vector<double> values(n);
+    for (size_t i = 0; i < n; ++i) values[i] = 0.5 + 0.5 * (double(i) / n);
+
+    runner.run("set_value", "virtual", n, [&] {
+        for (size_t i = 0; i < n; ++i) reals_base[i]->set_value(values[i]);
+    });
+    runner.run("set_value", "concrete", n, [&] {
+        for (size_t i = 0; i < n; ++i) reals[i]->Real::set_value(values[i]);
+    });
+    // Lazy parameters defer the log until the transformed value is read
+    runner.run("set_value_log", "concrete", n, [&] {
+        for (size_t i = 0; i < n; ++i) positives[i]->Positive::set_value(values[i]);
+    });
+    runner.run("set_value_log_lazy", "concrete", n, [&] {
+        for (size_t i = 0; i < n; ++i) positives_lazy[i]->Positive::set_value(values[i]);
+    });
+    runner.run("set_value_transformed", "virtual", n, [&] {
+        for (size_t i = 0; i < n; ++i) positives_base[i]->set_value_transformed(values[i]);
+    });
+    runner.run("set_value_transformed", "concrete", n, [&] {
+        for (size_t i = 0; i < n; ++i) positives[i]->Positive::set_value_transformed(values[i]);
+    });
+    // Storing the given transformed value saves a log per call
+    runner.run("set_value_transformed_exact", "concrete", n, [&] {
+        for (size_t i = 0; i < n; ++i) positives_exact[i]->Positive::set_value_transformed(values[i]);
+    });
+    runner.run("round_trip_error", "concrete", n, [&] {
+        double max = 0;
+        for (size_t i = 0; i < n; ++i) max = std::max(max, transform_log->round_trip_error(values[i]));
+        runner.sink = max;
+    });
+    runner.run("get_transform_derivative", "virtual", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += positives_base[i]->get_transform_derivative();
+        runner.sink = sum;
+    });
+    runner.run("get_transform_derivative", "concrete", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += positives[i]->Positive::get_transform_derivative();
+        runner.sink = sum;
+    });
+    runner.run("clip", "virtual", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += reals_base[i]->get_limits().clip(2 * values[i]);
+        runner.sink = sum;
+    });
+    runner.run("clip", "concrete", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += reals[i]->Real::get_limits().clip(2 * values[i]);
+        runner.sink = sum;
+    });
+    runner.run("forward", "virtual", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += positives_base[i]->get_transform().forward(values[i]);
+        runner.sink = sum;
+    });
+    runner.run("forward", "concrete", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += transform_log->Log::forward(values[i]);
+        runner.sink = sum;
+    });
+    runner.run("reverse", "virtual", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += positives_base[i]->get_transform().reverse(values[i]);
+        runner.sink = sum;
+    });
+    runner.run("reverse", "concrete", n, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += transform_log->Log::reverse(values[i]);
+        runner.sink = sum;
+    });
+    // Gathering unique parameters, each of which is listed twice
+    std::vector<std::shared_ptr<Base>> reals_shared(reals.begin(), reals.end());
+    runner.run("parameter_set_add_all", "concrete", n, [&] {
+        mod_params::ParameterSet<double> set;
+        set.add_all(reals_shared);
+        set.add_all(reals_shared);
+        runner.sink = set.size();
+    });
+    // One draw of n parameters, then n draws of one parameter
+    auto collection = mod_params::ParameterCollection<double>(reals_shared);
+    auto collection_one = mod_params::ParameterCollection<double>({reals_shared[0]});
+    auto sampler = mod_params::ParameterSampler<double>(collection);
+    auto sampler_one = mod_params::ParameterSampler<double>(collection_one);
+    std::vector<double> draws(n);
+    runner.run("sample_uniform", "concrete", n, [&] {
+        sampler.sample(draws);
+        runner.sink = draws[0];
+    });
+    runner.run("sample_uniform_draws", "concrete", n, [&] {
+        sampler_one.sample(draws, 0, n);
+        runner.sink = draws[0];
+    });
+    runner.run("repr", "virtual", n, [&] {
+        size_t size = 0;
+        for (size_t i = 0; i < n; ++i) size += reals_base[i]->repr().size();
+        runner.sink = size;
+    });
+    runner.run("repr", "concrete", n, [&] {
+        size_t size = 0;
+        for (size_t i = 0; i < n; ++i) size += reals[i]->Real::repr().size();
+        runner.sink = size;
+    });
+    runner.run("str", "virtual", n, [&] {
+        size_t size = 0;
+        for (size_t i = 0; i < n; ++i) size += reals_base[i]->str().size();
+        runner.sink = size;
+    });
+    runner.run("str", "concrete", n, [&] {
+        size_t size = 0;
+        for (size_t i = 0; i < n; ++i) size += reals[i]->Real::str().size();
+        runner.sink = size;
+    });
+}
+
+/**
+ * Benchmark common Parameter operations.
+ *
+ * Usage: benchmark_parameter [output.json] [n_parameters_max=1000000]
+ */
+int main(int argc, char** argv) {
+    const size_t n_max = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+    bench::Runner runner;
+    for (size_t n = 1; n <= n_max; n *= 10) run_size(runner, n);
+    return runner.write_json(argc, argv);
+}
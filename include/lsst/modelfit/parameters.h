@@ -25,11 +25,26 @@
 #ifndef LSST_MODELFIT_PARAMETERS_H
 #define LSST_MODELFIT_PARAMETERS_H
 
+#include "parameters/bounded_transform.h"
+#include "parameters/collection.h"
+#include "parameters/derived.h"
+#include "parameters/finite_difference.h"
+#include "parameters/fit_schedule.h"
+#include "parameters/id_table.h"
+#include "parameters/instrument.h"
 #include "parameters/limits.h"
 #include "parameters/object.h"
 #include "parameters/parameter.h"
+#include "parameters/parameter_array.h"
+#include "parameters/parameter_map.h"
+#include "parameters/parameter_set.h"
+#include "parameters/parameter_table.h"
+#include "parameters/reduced_problem.h"
+#include "parameters/sampler.h"
+#include "parameters/statistics.h"
 #include "parameters/transform.h"
 #include "parameters/type_name.h"
 #include "parameters/unit.h"
+#include "parameters/vector_transform.h"
 
 #endif  // LSST_MODELFIT_PARAMETERS_H
@@ -0,0 +1,274 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_BOUNDED_TRANSFORM_H
+#define LSST_MODELFIT_PARAMETERS_BOUNDED_TRANSFORM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "limits.h"
+#include "object.h"
+#include "parameter.h"
+#include "transform.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A transform of values within limits to unbounded values.
+ *
+ * The mapping depends on which of the limits are finite:
+ *  - both: a scaled logit, y = log(u / (1 - u)) with u = (x - min)/(max - min),
+ *  - min only: an inverse softplus, y = log(exp(x - min) - 1),
+ *  - max only: a negated inverse softplus, y = -log(exp(max - x) - 1),
+ *  - neither: the identity.
+ *
+ * Every finite transformed value reverses to a value within the limits, so
+ * optimizers need not handle limits. The limits are copied on construction;
+ * a new transform must be made if a parameter's limits change.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+class BoundedTransform : public Transform<T> {
+public:
+    /// Which of the limits are finite
+    enum class Kind { unbounded, lower, upper, both };
+
+private:
+    T _min;
+    T _max;
+    T _width;
+    Kind _kind;
+
+    /// Return log(exp(d) - 1) for d >= 0, without overflow for large d
+    static inline T _softplus_inverse(T d) { return d + std::log(-std::expm1(-d)); }
+    /// Return log(1 + exp(y)), without overflow for large y
+    static inline T _softplus(T y) { return std::max(y, T(0)) + std::log1p(std::exp(-std::abs(y))); }
+    /// Return the derivative of _softplus_inverse at d
+    static inline T _softplus_inverse_derivative(T d) { return -1 / std::expm1(-d); }
+    /// Return the second derivative of _softplus_inverse at d
+    static inline T _softplus_inverse_second_derivative(T d) {
+        const T denom = std::expm1(-d);
+        return -std::exp(-d) / (denom * denom);
+    }
+
+    template <Kind kind>
+    inline T _forward_kind(T x) const {
+        if constexpr (kind == Kind::both) {
+            const T u = (x - _min) / _width;
+            return std::log(u) - std::log1p(-u);
+        } else if constexpr (kind == Kind::lower) {
+            return _softplus_inverse(x - _min);
+        } else if constexpr (kind == Kind::upper) {
+            return -_softplus_inverse(_max - x);
+        } else {
+            return x;
+        }
+    }
+    template <Kind kind>
+    inline T _reverse_kind(T y) const {
+        if constexpr (kind == Kind::both) {
+            // Rounding could otherwise give a value just beyond the limits
+            const T x = _min + _width / (1 + std::exp(-y));
+            return x > _max ? _max : (x < _min ? _min : x);
+        } else if constexpr (kind == Kind::lower) {
+            return _min + _softplus(y);
+        } else if constexpr (kind == Kind::upper) {
+            return _max - _softplus(-y);
+        } else {
+            return y;
+        }
+    }
+    template <Kind kind>
+    inline T _derivative_kind(T x) const {
+        if constexpr (kind == Kind::both) {
+            const T u = (x - _min) / _width;
+            return 1 / (_width * u * (1 - u));
+        } else if constexpr (kind == Kind::lower) {
+            return _softplus_inverse_derivative(x - _min);
+        } else if constexpr (kind == Kind::upper) {
+            return _softplus_inverse_derivative(_max - x);
+        } else {
+            return 1;
+        }
+    }
+    template <Kind kind>
+    inline T _log_abs_derivative_kind(T x) const {
+        if constexpr (kind == Kind::both) {
+            const T u = (x - _min) / _width;
+            return -std::log(_width) - std::log(u) - std::log1p(-u);
+        } else if constexpr (kind == Kind::lower) {
+            return -std::log(-std::expm1(-(x - _min)));
+        } else if constexpr (kind == Kind::upper) {
+            return -std::log(-std::expm1(-(_max - x)));
+        } else {
+            return 0;
+        }
+    }
+    template <Kind kind>
+    inline T _second_derivative_kind(T x) const {
+        if constexpr (kind == Kind::both) {
+            const T u = (x - _min) / _width;
+            const T denom = _width * u * (1 - u);
+            return -(1 - 2 * u) / (denom * denom);
+        } else if constexpr (kind == Kind::lower) {
+            return _softplus_inverse_second_derivative(x - _min);
+        } else if constexpr (kind == Kind::upper) {
+            return -_softplus_inverse_second_derivative(_max - x);
+        } else {
+            return 0;
+        }
+    }
+
+    /// Call func with the kind of mapping as a std::integral_constant
+    template <typename F>
+    decltype(auto) _visit(F&& func) const {
+        switch (_kind) {
+            case Kind::both:
+                return func(std::integral_constant<Kind, Kind::both>{});
+            case Kind::lower:
+                return func(std::integral_constant<Kind, Kind::lower>{});
+            case Kind::upper:
+                return func(std::integral_constant<Kind, Kind::upper>{});
+            case Kind::unbounded:
+            default:
+                return func(std::integral_constant<Kind, Kind::unbounded>{});
+        }
+    }
+
+public:
+    std::string description() const override { return "Limits-aware bounded to unbounded transform"; }
+
+    /// Return which of the limits are finite
+    Kind get_kind() const { return _kind; }
+    /// Return the minimum untransformed value
+    T get_min() const { return _min; }
+    /// Return the maximum untransformed value
+    T get_max() const { return _max; }
+
+    T derivative(T x) const override {
+        return _visit([this, x](auto kind) { return _derivative_kind<decltype(kind)::value>(x); });
+    }
+    T log_abs_derivative(T x) const override {
+        return _visit([this, x](auto kind) { return _log_abs_derivative_kind<decltype(kind)::value>(x); });
+    }
+    T forward(T x) const override {
+        return _visit([this, x](auto kind) { return _forward_kind<decltype(kind)::value>(x); });
+    }
+    T reverse(T x) const override {
+        return _visit([this, x](auto kind) { return _reverse_kind<decltype(kind)::value>(x); });
+    }
+    T second_derivative(T x) const override {
+        return _visit([this, x](auto kind) { return _second_derivative_kind<decltype(kind)::value>(x); });
+    }
+
+    // The batch methods dispatch once outside of each loop, so that loops can be inlined and vectorized
+    void derivative_batch(const T* x, T* out, size_t n) const override {
+        _visit([this, x, out, n](auto kind) {
+            for (size_t i = 0; i < n; ++i) out[i] = _derivative_kind<decltype(kind)::value>(x[i]);
+        });
+    }
+    void log_abs_derivative_batch(const T* x, T* out, size_t n) const override {
+        _visit([this, x, out, n](auto kind) {
+            for (size_t i = 0; i < n; ++i) out[i] = _log_abs_derivative_kind<decltype(kind)::value>(x[i]);
+        });
+    }
+    void forward_batch(const T* x, T* out, size_t n) const override {
+        _visit([this, x, out, n](auto kind) {
+            for (size_t i = 0; i < n; ++i) out[i] = _forward_kind<decltype(kind)::value>(x[i]);
+        });
+    }
+    void reverse_batch(const T* x, T* out, size_t n) const override {
+        _visit([this, x, out, n](auto kind) {
+            for (size_t i = 0; i < n; ++i) out[i] = _reverse_kind<decltype(kind)::value>(x[i]);
+        });
+    }
+    void second_derivative_batch(const T* x, T* out, size_t n) const override {
+        _visit([this, x, out, n](auto kind) {
+            for (size_t i = 0; i < n; ++i) out[i] = _second_derivative_kind<decltype(kind)::value>(x[i]);
+        });
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<BoundedTransform<T>>(false, namespace_separator) + "("
+               + (name_keywords ? "min=" : "") + std::to_string(_min) + ", " + (name_keywords ? "max=" : "")
+               + std::to_string(_max) + ")";
+    }
+    std::string str() const override {
+        return type_name_str<BoundedTransform<T>>(true) + "(min=" + std::to_string(_min)
+               + ", max=" + std::to_string(_max) + ")";
+    }
+
+    /**
+     * Initialize a BoundedTransform from limits.
+     *
+     * @param limits The limits of the untransformed values, which must not
+     *      be periodic or have min == max.
+     */
+    explicit BoundedTransform(const Limits<T>& limits)
+            : _min(limits.get_min()),
+              _max(limits.get_max()),
+              _width(_max - _min),
+              _kind(std::isfinite(_min) ? (std::isfinite(_max) ? Kind::both : Kind::lower)
+                                        : (std::isfinite(_max) ? Kind::upper : Kind::unbounded)) {
+        if (limits.get_periodic()) {
+            throw std::invalid_argument(this->str() + " can't be initialized with periodic " + limits.str());
+        }
+        if (!(_min < _max)) {
+            throw std::invalid_argument(this->str() + " can't be initialized with !(min < max)");
+        }
+    }
+    ~BoundedTransform() = default;
+};
+
+/**
+ * Make a BoundedTransform for a parameter's current limits.
+ *
+ * The limits are the intersection of get_limits() and get_limits_maximal().
+ * Periodic parameters are unbounded, since setting their values wraps them.
+ *
+ * @param parameter The parameter to make a transform for. The transform is
+ *      not set; call parameter.set_transform with the result to do so.
+ * @return A new BoundedTransform.
+ */
+template <typename T>
+std::shared_ptr<const BoundedTransform<T>> make_bounded_transform(const ParameterBase<T>& parameter) {
+    const auto& limits = parameter.get_limits();
+    if (limits.get_periodic()) return std::make_shared<const BoundedTransform<T>>(Limits<T>());
+    const auto& limits_maximal = parameter.get_limits_maximal();
+    return std::make_shared<const BoundedTransform<T>>(
+            Limits<T>(std::max(limits.get_min(), limits_maximal.get_min()),
+                      std::min(limits.get_max(), limits_maximal.get_max()), limits.name));
+}
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_BOUNDED_TRANSFORM_H
@@ -0,0 +1,1227 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_COLLECTION_H
+#define LSST_MODELFIT_PARAMETERS_COLLECTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bounded_transform.h"
+#include "instrument.h"
+#include "object.h"
+#include "parameter.h"
+#include "parameter_map.h"
+#include "type_name.h"
+#include "vector_transform.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief An ordered collection of parameters.
+ *
+ * Collections provide bulk operations on the free parameters they contain,
+ * in the order that they were added. Vector arguments are indexed by free
+ * parameter and must already be of the correct size; they are not resized.
+ *
+ * Parameters may be tied to another parameter in the collection, in which
+ * case they are not considered free and are set from the value of the other
+ * parameter whenever the collection sets values.
+ *
+ * Groups of parameters may also be transformed jointly by a VectorTransform,
+ * in which case the collection's transformed values for those parameters
+ * are those of the VectorTransform rather than of each parameter's own
+ * (unit) Transform.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ *
+ * @note The free/fixed status of each parameter is checked on every call.
+ */
+template <typename T>
+class ParameterCollection : public Object {
+public:
+    using ParamPtr = std::shared_ptr<ParameterBase<T>>;
+
+    /// An affine relation setting one parameter's value from another's
+    struct Tie {
+        /// The parameter to set
+        ParamPtr dependent;
+        /// The index of the independent parameter in this collection
+        size_t index;
+        T scale;
+        T offset;
+    };
+
+    /// Candidate steps evaluated by evaluate_steps, which may be reused between calls
+    struct StepCandidates {
+        /// The number of free parameters
+        size_t n_free = 0;
+        /// The step lengths of the candidates
+        std::vector<T> alphas;
+        /// The untransformed values, row-major with one row of n_free values per candidate
+        std::vector<T> values;
+        /// The transformed values, in the same order as values
+        std::vector<T> values_transformed;
+        /// Whether each of the values is within limits, in the same order as values
+        std::vector<bool> feasible;
+
+        /// Return whether all of the values of a candidate are within limits
+        bool get_feasible(size_t index) const {
+            const auto begin = feasible.begin() + index * n_free;
+            return std::find(begin, begin + n_free, false) == begin + n_free;
+        }
+        /// Return the number of candidates
+        size_t size() const { return alphas.size(); }
+    };
+
+    /// The free parameters partitioned by whether they are linear (see ParameterBase::get_linear)
+    struct LinearPartition {
+        /// The index of each linear parameter in this collection
+        std::vector<size_t> indices_linear;
+        /// The index of each nonlinear parameter in this collection
+        std::vector<size_t> indices_nonlinear;
+        /// The index of each linear parameter in the free values
+        std::vector<size_t> indices_free_linear;
+        /// The index of each nonlinear parameter in the free values
+        std::vector<size_t> indices_free_nonlinear;
+    };
+
+    /// Free parameters sharing a Transform, which are transformed in one batch
+    struct TransformPlan {
+        /// The shared transform
+        const Transform<T>* transform;
+        /// The indices of the parameters in the free values
+        std::vector<size_t> indices_free;
+        /// The parameters, in the same order as indices_free
+        std::vector<ParameterBase<T>*> parameters;
+    };
+
+    /// A VectorTransform applied jointly to a group of parameters
+    struct TransformGroup {
+        std::shared_ptr<const VectorTransform<T>> transform;
+        /// The indices of the parameters in this collection
+        std::vector<size_t> indices;
+    };
+
+private:
+    std::vector<ParamPtr> _parameters;
+    /// The (first) index of each parameter
+    ParameterMap<T, size_t> _indices;
+    /// Whether each parameter is the dependent of a Tie
+    std::vector<bool> _is_dependent;
+    std::vector<Tie> _ties;
+    /// Whether each parameter is in a TransformGroup
+    std::vector<bool> _is_grouped;
+    std::vector<TransformGroup> _groups;
+    /// The default policy for values beyond limits when setting values
+    LimitPolicy _limit_policy = LimitPolicy::error;
+    /// Whether parameters compute transformed values lazily
+    bool _transformed_lazy = false;
+    /// The number of times parameters, ties or groups have been added or removed
+    uint64_t _version_structure = 0;
+    /// ParameterBase::get_structure_epoch() when _version_parameters was last checked
+    mutable uint64_t _epoch_parameters = 0;
+    /// The sum of the parameters' structure versions when last checked
+    mutable uint64_t _sum_versions_parameters = 0;
+    /// The number of times the sum of the parameters' structure versions has changed
+    mutable uint64_t _version_parameters = 0;
+    /*
+     * Scratch buffers, which are reused between calls to avoid allocating.
+     * Methods using them (including const ones) can't be called concurrently.
+     */
+    /// Transformed and untransformed values of the free parameters
+    mutable std::vector<T> _buffer;
+    std::vector<T> _buffer_values;
+    /// Values for one plan, or one parameter's values for many candidates or sets
+    mutable std::vector<T> _buffer_plan;
+    mutable std::vector<T> _buffer_plan_transformed;
+    /// Values for one TransformGroup, sized for the largest when computing _groups_indices_free
+    mutable std::vector<T> _buffer_group;
+    mutable std::vector<T> _buffer_group_transformed;
+    mutable std::vector<T> _buffer_group_other;
+    mutable std::vector<T> _buffer_group_jacobian;
+
+    /*
+     * Views of the structure, which are cached until this collection's or
+     * its parameters' structure versions change (see _check_caches)
+     */
+    mutable uint64_t _cache_version = 0;
+    mutable uint64_t _cache_version_parameters = 0;
+    /// The linear partition
+    mutable LinearPartition _partition;
+    mutable bool _partition_computed = false;
+    /// The indices in the free values of each TransformGroup
+    mutable std::vector<std::vector<size_t>> _groups_indices_free;
+    mutable bool _groups_computed = false;
+    /// The free, ungrouped parameters sharing each Transform
+    mutable std::vector<TransformPlan> _plans;
+    /// The index in the free values of each parameter, or size() if not free
+    mutable std::vector<size_t> _indices_free;
+    mutable bool _plans_computed = false;
+
+    /// Invalidate all cached views if this collection's or its parameters' structure has changed
+    void _check_caches() const {
+        const uint64_t version_parameters = get_structure_version_parameters();
+        if ((_cache_version != _version_structure) || (_cache_version_parameters != version_parameters)) {
+            _partition_computed = false;
+            _groups_computed = false;
+            _plans_computed = false;
+            _cache_version = _version_structure;
+            _cache_version_parameters = version_parameters;
+        }
+    }
+
+    /**
+     * Call func(parameter, index_free) for each free parameter.
+     *
+     * @tparam skip_grouped Whether to skip parameters in a TransformGroup
+     *      (while still counting them in index_free).
+     */
+    template <bool skip_grouped = false, typename F>
+    void _for_each_free(F&& func) const {
+        size_t idx = 0;
+        const size_t n_params = _parameters.size();
+        for (size_t idx_param = 0; idx_param < n_params; ++idx_param) {
+            auto& parameter = *_parameters[idx_param];
+            if (parameter.get_free() && !_is_dependent[idx_param]) {
+                if (!(skip_grouped && _is_grouped[idx_param])) func(parameter, idx);
+                ++idx;
+            }
+        }
+    }
+
+    /// Return the free, ungrouped parameters sharing each Transform, recomputing them if stale
+    const std::vector<TransformPlan>& _get_plans() const {
+        _check_caches();
+        if (_plans_computed) return _plans;
+        const size_t n_params = _parameters.size();
+        _plans.clear();
+        _indices_free.assign(n_params, n_params);
+        size_t idx = 0;
+        for (size_t idx_param = 0; idx_param < n_params; ++idx_param) {
+            auto& parameter = *_parameters[idx_param];
+            if (!parameter.get_free() || _is_dependent[idx_param]) continue;
+            _indices_free[idx_param] = idx;
+            if (!_is_grouped[idx_param]) {
+                const Transform<T>* transform = &parameter.get_transform();
+                auto found = std::find_if(_plans.begin(), _plans.end(),
+                                          [transform](const TransformPlan& plan) {
+                                              return plan.transform == transform;
+                                          });
+                if (found == _plans.end()) found = _plans.insert(_plans.end(), {transform, {}, {}});
+                found->indices_free.push_back(idx);
+                found->parameters.push_back(&parameter);
+            }
+            ++idx;
+        }
+        _plans_computed = true;
+        return _plans;
+    }
+
+    /// Return the indices in the free values of each TransformGroup, recomputing them if stale
+    const std::vector<std::vector<size_t>>& _get_groups_indices_free() const {
+        _check_caches();
+        if (_groups_computed) return _groups_indices_free;
+        const size_t n_params = _parameters.size();
+        std::vector<size_t> indices_free(n_params, n_params);
+        size_t idx = 0;
+        for (size_t idx_param = 0; idx_param < n_params; ++idx_param) {
+            if (_parameters[idx_param]->get_free() && !_is_dependent[idx_param]) {
+                indices_free[idx_param] = idx++;
+            }
+        }
+        _groups_indices_free.resize(_groups.size());
+        size_t n_group_max = 0;
+        for (const auto& group : _groups) n_group_max = std::max(n_group_max, group.indices.size());
+        _buffer_group.resize(n_group_max);
+        _buffer_group_transformed.resize(n_group_max);
+        _buffer_group_other.resize(n_group_max);
+        _buffer_group_jacobian.resize(n_group_max * n_group_max);
+        for (size_t idx_group = 0; idx_group < _groups.size(); ++idx_group) {
+            const auto& group = _groups[idx_group];
+            auto& indices_group = _groups_indices_free[idx_group];
+            indices_group.clear();
+            for (size_t idx_param : group.indices) {
+                if (indices_free[idx_param] == n_params) {
+                    throw std::logic_error(this->str() + " can't apply " + group.transform->str()
+                                           + " to group with fixed " + _parameters[idx_param]->str());
+                }
+                indices_group.push_back(indices_free[idx_param]);
+            }
+        }
+        _groups_computed = true;
+        return _groups_indices_free;
+    }
+
+    /// Call func(group, indices_free) for each TransformGroup
+    template <typename F>
+    void _for_each_group(F&& func) const {
+        if (_groups.empty()) return;
+        const auto& groups_indices_free = _get_groups_indices_free();
+        const size_t n_groups = _groups.size();
+        for (size_t idx_group = 0; idx_group < n_groups; ++idx_group) {
+            func(_groups[idx_group], groups_indices_free[idx_group]);
+        }
+    }
+
+    /**
+     * Throw if any new values of free parameters from apply_step, or of the
+     * parameters tied to them, are beyond limits.
+     */
+    void _check_step(const T* values, const std::vector<bool>& at_limits) const {
+        const size_t n_params = _parameters.size();
+        for (size_t idx_param = 0; idx_param < n_params; ++idx_param) {
+            const size_t idx = _indices_free[idx_param];
+            if ((idx < n_params) && at_limits[idx]) {
+                throw std::runtime_error(this->str() + ".apply_step would set value="
+                                         + std::to_string(values[idx]) + " beyond limits of "
+                                         + _parameters[idx_param]->str());
+            }
+        }
+        for (const auto& tie : _ties) {
+            const size_t idx = _indices_free[tie.index];
+            const T value = tie.scale * ((idx < n_params) ? values[idx] : _parameters[tie.index]->get_value())
+                            + tie.offset;
+            const auto& limits = tie.dependent->get_limits();
+            if (!limits.check(limits.wrap(value))) {
+                throw std::runtime_error(this->str() + ".apply_step would set tied value="
+                                         + std::to_string(value) + " beyond limits of "
+                                         + tie.dependent->str());
+            }
+        }
+    }
+
+    void _check_no_groups(std::string_view method) const {
+        if (!_groups.empty()) {
+            throw std::logic_error(this->str() + "." + std::string(method)
+                                   + " does not support parameters with a VectorTransform");
+        }
+    }
+
+    /// Set values of the parameters at the given indices, then update ties
+    template <bool transformed>
+    T _set_values_indexed(const std::vector<size_t>& indices, const std::vector<T>& values,
+                          LimitPolicy policy) {
+        _check_size(values, indices.size(), "values");
+        T penalty = 0;
+        const size_t n_values = indices.size();
+        for (size_t idx = 0; idx < n_values; ++idx) {
+            auto& parameter = *_parameters[indices[idx]];
+            if constexpr (transformed) {
+                penalty += parameter.set_value_transformed(values[idx], policy);
+            } else {
+                penalty += parameter.set_value(values[idx], policy);
+            }
+        }
+        penalty += update_ties(policy);
+        return penalty;
+    }
+
+    template <typename V>
+    void _check_size(const std::vector<V>& values, size_t size, std::string_view name) const {
+        if (values.size() != size) {
+            throw std::invalid_argument(this->str() + " given " + std::string(name)
+                                        + ".size()=" + std::to_string(values.size())
+                                        + " != expected=" + std::to_string(size));
+        }
+    }
+
+public:
+    /// Add a parameter to the end of this collection
+    void add(ParamPtr parameter) {
+        if (parameter == nullptr) throw std::invalid_argument(this->str() + " can't add a null parameter");
+        if (_transformed_lazy) parameter->set_transformed_lazy(true);
+        if (!_indices.contains(*parameter)) _indices.set(*parameter, _parameters.size());
+        _parameters.emplace_back(std::move(parameter));
+        _is_dependent.push_back(false);
+        _is_grouped.push_back(false);
+        _sum_versions_parameters += _parameters.back()->get_version_structure();
+        ++_version_structure;
+    }
+
+    /// Return the parameter at a given index (including fixed parameters)
+    ParameterBase<T>& at(size_t index) const { return *_parameters.at(index); }
+
+    /**
+     * Transform a group of parameters jointly with a VectorTransform.
+     *
+     * @param transform The transform to apply.
+     * @param parameters The parameters in this collection to transform, in
+     *      the order expected by the transform. They must have unit (scalar)
+     *      transforms, must not be in another group or tied, and must be free
+     *      whenever values are transformed.
+     */
+    void add_vector_transform(std::shared_ptr<const VectorTransform<T>> transform,
+                              const std::vector<ParamPtr>& parameters) {
+        if (transform == nullptr) throw std::invalid_argument(this->str() + " given null vector transform");
+        if (parameters.size() != transform->size()) {
+            throw std::invalid_argument(this->str() + " given " + std::to_string(parameters.size())
+                                        + " parameters for " + transform->str());
+        }
+        std::vector<size_t> indices;
+        for (const auto& parameter : parameters) {
+            if (parameter == nullptr) throw std::invalid_argument(this->str() + " given null parameter");
+            const size_t index = get_index(*parameter);
+            if (_is_grouped[index] || _is_dependent[index]
+                || (std::find(indices.begin(), indices.end(), index) != indices.end())) {
+                throw std::invalid_argument(this->str() + " can't add tied or already-grouped "
+                                            + parameter->str() + " to a vector transform group");
+            }
+            if (dynamic_cast<const UnitTransform<T>*>(&parameter->get_transform()) == nullptr) {
+                throw std::invalid_argument(this->str() + " can't add " + parameter->str()
+                                            + " with a non-unit transform to a vector transform group");
+            }
+            indices.push_back(index);
+        }
+        for (size_t index : indices) _is_grouped[index] = true;
+        _groups.push_back({std::move(transform), std::move(indices)});
+        ++_version_structure;
+    }
+
+    /// Return whether a parameter is in this collection
+    bool contains(const ParameterBase<T>& parameter) const { return _indices.contains(parameter); }
+
+    /// Return the index of a parameter in this collection, throwing if it is not found
+    size_t get_index(const ParameterBase<T>& parameter) const {
+        if (_indices.contains(parameter)) return _indices.at(parameter);
+        throw std::invalid_argument(this->str() + " does not contain " + parameter.str());
+    }
+
+    /**
+     * Return the free parameters partitioned into linear and nonlinear sets.
+     *
+     * The partition is cached until the free status or transform of any of
+     * this collection's parameters or this collection's structure changes.
+     *
+     * @throws std::logic_error If there are vector transform groups, which
+     *      are not supported.
+     */
+    const LinearPartition& get_linear_partition() const {
+        _check_no_groups("get_linear_partition");
+        _check_caches();
+        if (!_partition_computed) {
+            _partition = LinearPartition();
+            const size_t n_params = _parameters.size();
+            size_t idx = 0;
+            for (size_t index = 0; index < n_params; ++index) {
+                const auto& parameter = *_parameters[index];
+                if (!parameter.get_free() || _is_dependent[index]) continue;
+                if (parameter.get_linear()) {
+                    _partition.indices_linear.push_back(index);
+                    _partition.indices_free_linear.push_back(idx);
+                } else {
+                    _partition.indices_nonlinear.push_back(index);
+                    _partition.indices_free_nonlinear.push_back(idx);
+                }
+                ++idx;
+            }
+            _partition_computed = true;
+        }
+        return _partition;
+    }
+
+    /// Return the number of free (and untied) parameters
+    size_t get_n_free() const {
+        size_t n_free = 0;
+        _for_each_free([&n_free](const ParameterBase<T>&, size_t) { ++n_free; });
+        return n_free;
+    }
+
+    /// Return the parameters in this collection
+    const std::vector<ParamPtr>& get_parameters() const { return _parameters; }
+
+    /// Return the free (and untied) parameters, in the order of the free values
+    std::vector<ParamPtr> get_parameters_free() const {
+        std::vector<ParamPtr> parameters_free;
+        const size_t n_params = _parameters.size();
+        for (size_t idx_param = 0; idx_param < n_params; ++idx_param) {
+            if (_parameters[idx_param]->get_free() && !_is_dependent[idx_param]) {
+                parameters_free.push_back(_parameters[idx_param]);
+            }
+        }
+        return parameters_free;
+    }
+
+    /**
+     * Write the transformed-space limits of the free parameters to lower and upper.
+     *
+     * Parameters with a VectorTransform are given infinite bounds.
+     */
+    void get_limits_transformed(std::vector<T>& lower, std::vector<T>& upper) const {
+        const size_t n_free = get_n_free();
+        _check_size(lower, n_free, "lower");
+        _check_size(upper, n_free, "upper");
+        _for_each_free([&lower, &upper](const ParameterBase<T>& parameter, size_t idx) {
+            const auto& limits = parameter.get_limits_transformed();
+            lower[idx] = limits.get_min();
+            upper[idx] = limits.get_max();
+        });
+        _for_each_group([&lower, &upper](const TransformGroup&, const std::vector<size_t>& indices) {
+            for (size_t idx : indices) {
+                lower[idx] = -std::numeric_limits<T>::infinity();
+                upper[idx] = std::numeric_limits<T>::infinity();
+            }
+        });
+    }
+
+    /// Return the default policy for values beyond limits when setting values
+    LimitPolicy get_limit_policy() const { return _limit_policy; }
+
+    /// Return whether parameters compute transformed values lazily
+    bool get_transformed_lazy() const { return _transformed_lazy; }
+
+    /**
+     * Write the round trip error of each free parameter's transformed value
+     * to errors.
+     *
+     * This is the absolute change in the transformed value after reversing
+     * and then transforming it, which is the error incurred by storing given
+     * transformed values (see ParameterBase::set_transformed_exact).
+     */
+    void get_round_trip_errors(std::vector<T>& errors) const {
+        _check_size(errors, get_n_free(), "errors");
+        _for_each_free<true>([&errors](const ParameterBase<T>& parameter, size_t idx) {
+            errors[idx] = parameter.get_transform().round_trip_error(parameter.get_value_transformed());
+        });
+        _for_each_group([this, &errors](const TransformGroup& group, const std::vector<size_t>& indices) {
+            const size_t n_values = indices.size();
+            T* values_group = _buffer_group.data();
+            T* values_transformed = _buffer_group_transformed.data();
+            T* values_round_trip = _buffer_group_other.data();
+            for (size_t k = 0; k < n_values; ++k) {
+                values_group[k] = _parameters[group.indices[k]]->get_value();
+            }
+            group.transform->forward(values_group, values_transformed);
+            group.transform->reverse(values_transformed, values_group);
+            group.transform->forward(values_group, values_round_trip);
+            for (size_t k = 0; k < n_values; ++k) {
+                errors[indices[k]] = std::abs(values_round_trip[k] - values_transformed[k]);
+            }
+        });
+    }
+
+    /**
+     * Return a counter that is incremented whenever parameters, ties or
+     * vector transform groups are added or removed.
+     *
+     * @see ParameterBase::get_structure_epoch
+     */
+    uint64_t get_structure_version() const { return _version_structure; }
+
+    /**
+     * Return a counter that is incremented whenever the free status or
+     * transform of any parameter in this collection changes.
+     *
+     * Changes to parameters in other collections don't change this, although
+     * they do require summing this collection's parameters' structure
+     * versions on the next call.
+     *
+     * @see ParameterBase::get_version_structure
+     */
+    uint64_t get_structure_version_parameters() const {
+        const uint64_t epoch = ParameterBase<T>::get_structure_epoch();
+        if (epoch != _epoch_parameters) {
+            // Structure versions only increase, so any change increases the sum
+            uint64_t sum = 0;
+            for (const auto& parameter : _parameters) sum += parameter->get_version_structure();
+            if (sum != _sum_versions_parameters) {
+                _sum_versions_parameters = sum;
+                ++_version_parameters;
+            }
+            _epoch_parameters = epoch;
+        }
+        return _version_parameters;
+    }
+
+    /// Return whether each parameter is the dependent of a Tie
+    const std::vector<bool>& get_is_dependent() const { return _is_dependent; }
+
+    /**
+     * Return the free parameters that aren't in a vector transform group,
+     * with one plan per distinct Transform in order of first appearance.
+     *
+     * The plans are cached until the free status or transform of any of
+     * this collection's parameters or this collection's structure changes.
+     */
+    const std::vector<TransformPlan>& get_plans() const { return _get_plans(); }
+
+    /// Return the ties between parameters
+    const std::vector<Tie>& get_ties() const { return _ties; }
+
+    /// Return the groups of parameters with a VectorTransform
+    const std::vector<TransformGroup>& get_vector_transforms() const { return _groups; }
+
+    /// Write the untransformed values of the free parameters to values
+    void get_values(std::vector<T>& values) const {
+        _check_size(values, get_n_free(), "values");
+        _for_each_free([&values](const ParameterBase<T>& parameter, size_t idx) {
+            values[idx] = parameter.get_value();
+        });
+    }
+
+    /// Write the untransformed values of the free linear parameters to values
+    void get_values_linear(std::vector<T>& values) const {
+        const auto& indices = get_linear_partition().indices_linear;
+        _check_size(values, indices.size(), "values");
+        const size_t n_values = indices.size();
+        for (size_t idx = 0; idx < n_values; ++idx) values[idx] = _parameters[indices[idx]]->get_value();
+    }
+
+    /// Write the transformed values of the free nonlinear parameters to values
+    void get_values_nonlinear_transformed(std::vector<T>& values) const {
+        const auto& indices = get_linear_partition().indices_nonlinear;
+        _check_size(values, indices.size(), "values");
+        const size_t n_values = indices.size();
+        for (size_t idx = 0; idx < n_values; ++idx) {
+            values[idx] = _parameters[indices[idx]]->get_value_transformed();
+        }
+    }
+
+    /// Write the transformed values of the free parameters to values
+    void get_values_transformed(std::vector<T>& values) const {
+        _check_size(values, get_n_free(), "values");
+        _for_each_free<true>([&values](const ParameterBase<T>& parameter, size_t idx) {
+            values[idx] = parameter.get_value_transformed();
+        });
+        _for_each_group([this, &values](const TransformGroup& group, const std::vector<size_t>& indices) {
+            const size_t n_values = indices.size();
+            for (size_t k = 0; k < n_values; ++k) {
+                _buffer_group[k] = _parameters[group.indices[k]]->get_value();
+            }
+            group.transform->forward(_buffer_group.data(), _buffer_group_transformed.data());
+            for (size_t k = 0; k < n_values; ++k) values[indices[k]] = _buffer_group_transformed[k];
+        });
+    }
+
+    /**
+     * Set the transform of each free parameter to a BoundedTransform for its
+     * current limits, so that any finite transformed values are valid.
+     *
+     * Values on a finite bound, which would transform to an infinite value,
+     * are first moved inward by sqrt(epsilon) times the width of the limits
+     * (or the magnitude of the bound, if larger than one, for one-sided
+     * limits), up to half the width.
+     *
+     * Parameters that are tied or in a VectorTransform group are unchanged.
+     * This must be called again if any limits change.
+     */
+    void set_transforms_bounded() {
+        _for_each_free<true>([this](ParameterBase<T>& parameter, size_t) {
+            auto transform = make_bounded_transform(parameter);
+            const T min = transform->get_min();
+            const T max = transform->get_max();
+            const T value = parameter.get_value();
+            const bool at_min = std::isfinite(min) && !(value > min);
+            const bool at_max = std::isfinite(max) && !(value < max);
+            if (at_min || at_max) {
+                const T bound = at_min ? min : max;
+                const T width = max - min;
+                const T scale = std::isfinite(width) ? width : std::max(std::abs(bound), T(1));
+                const T nudge = std::min(std::sqrt(std::numeric_limits<T>::epsilon()) * scale, width / 2);
+                parameter.set_value(at_min ? (min + nudge) : (max - nudge));
+            }
+            const T value_transformed = transform->forward(parameter.get_value());
+            if (!std::isfinite(value_transformed)) {
+                throw std::runtime_error(this->str() + ".set_transforms_bounded got transformed value="
+                                         + std::to_string(value_transformed) + " for "
+                                         + parameter.str());
+            }
+            parameter.set_transform(std::move(transform));
+        });
+    }
+
+    /// Set the default policy for values beyond limits when setting values
+    void set_limit_policy(LimitPolicy policy) { _limit_policy = policy; }
+
+    /**
+     * Set whether all parameters (including those added later) compute
+     * transformed values lazily, on first read.
+     *
+     * Stale transformed values of free parameters are computed when gathered
+     * by get_values_transformed, in one batch per ParameterArray.
+     *
+     * @see ParameterBase::set_transformed_lazy
+     */
+    void set_transformed_lazy(bool lazy) {
+        _transformed_lazy = lazy;
+        for (const auto& parameter : _parameters) parameter->set_transformed_lazy(lazy);
+    }
+
+    /**
+     * Set the untransformed values of the free parameters.
+     *
+     * @return The total penalty if the limit policy is LimitPolicy::penalize,
+     *      or else zero.
+     */
+    T set_values(const std::vector<T>& values) { return set_values(values, _limit_policy); }
+
+    /// Set the untransformed values of the free parameters with a given limit policy
+    T set_values(const std::vector<T>& values, LimitPolicy policy) {
+        _check_size(values, get_n_free(), "values");
+        T penalty = 0;
+        _for_each_free([&values, &penalty, policy](ParameterBase<T>& parameter, size_t idx) {
+            penalty += parameter.set_value(values[idx], policy);
+        });
+        penalty += update_ties(policy);
+        return penalty;
+    }
+
+    /**
+     * Set the untransformed values of the free linear parameters, e.g. as
+     * solved for given the nonlinear parameters' values, and update ties.
+     *
+     * @return The total penalty if the limit policy is LimitPolicy::penalize,
+     *      or else zero.
+     */
+    T set_values_linear(const std::vector<T>& values) { return set_values_linear(values, _limit_policy); }
+
+    /// Set the untransformed values of the free linear parameters with a given limit policy
+    T set_values_linear(const std::vector<T>& values, LimitPolicy policy) {
+        return _set_values_indexed<false>(get_linear_partition().indices_linear, values, policy);
+    }
+
+    /**
+     * Set the transformed values of the free nonlinear parameters and update
+     * ties.
+     *
+     * @return The total penalty if the limit policy is LimitPolicy::penalize,
+     *      or else zero.
+     */
+    T set_values_nonlinear_transformed(const std::vector<T>& values) {
+        return set_values_nonlinear_transformed(values, _limit_policy);
+    }
+
+    /// Set the transformed values of the free nonlinear parameters with a given limit policy
+    T set_values_nonlinear_transformed(const std::vector<T>& values, LimitPolicy policy) {
+        return _set_values_indexed<true>(get_linear_partition().indices_nonlinear, values, policy);
+    }
+
+    /**
+     * Set the transformed values of the free parameters.
+     *
+     * @return The total penalty if the limit policy is LimitPolicy::penalize,
+     *      or else zero.
+     */
+    T set_values_transformed(const std::vector<T>& values) {
+        return set_values_transformed(values, _limit_policy);
+    }
+
+    /// Set the transformed values of the free parameters with a given limit policy
+    T set_values_transformed(const std::vector<T>& values, LimitPolicy policy) {
+        _check_size(values, get_n_free(), "values");
+        T penalty = 0;
+        _for_each_free<true>([&values, &penalty, policy](ParameterBase<T>& parameter, size_t idx) {
+            penalty += parameter.set_value_transformed(values[idx], policy);
+        });
+        _for_each_group([this, &values, &penalty, policy](const TransformGroup& group,
+                                                          const std::vector<size_t>& indices) {
+            const size_t n_values = indices.size();
+            for (size_t k = 0; k < n_values; ++k) _buffer_group_transformed[k] = values[indices[k]];
+            group.transform->reverse(_buffer_group_transformed.data(), _buffer_group.data());
+            for (size_t k = 0; k < n_values; ++k) {
+                penalty += _parameters[group.indices[k]]->set_value(_buffer_group[k], policy);
+            }
+        });
+        penalty += update_ties(policy);
+        return penalty;
+    }
+
+    /**
+     * Add a step to the transformed values of the free parameters.
+     *
+     * New transformed values are reversed in one batch per distinct
+     * Transform, then set along with their new untransformed values (see
+     * ParameterBase::set_value_with_transformed), so that parameters with
+     * exact transformed values enabled needn't transform them again.
+     *
+     * With LimitPolicy::error, all new values (including those of tied
+     * parameters) are checked before any are set, so that no values are
+     * changed if any would be beyond limits.
+     *
+     * @param direction The step direction in transformed space.
+     * @param alpha The step length.
+     * @param policy The policy for untransformed values beyond limits.
+     * @param at_limits Set to whether each parameter's untransformed value
+     *      was beyond its limits (after any periodic wrapping).
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T apply_step(const std::vector<T>& direction, T alpha, LimitPolicy policy, std::vector<bool>& at_limits) {
+        const size_t n_free = get_n_free();
+        _check_size(direction, n_free, "direction");
+        _check_size(at_limits, n_free, "at_limits");
+        _buffer.resize(n_free);
+        _buffer_values.resize(n_free);
+        get_values_transformed(_buffer);
+        T* values_transformed = _buffer.data();
+        T* values = _buffer_values.data();
+        const T* step = direction.data();
+        for (size_t idx = 0; idx < n_free; ++idx) values_transformed[idx] += alpha * step[idx];
+
+        const auto& plans = _get_plans();
+        for (const auto& plan : plans) {
+            const size_t n_values = plan.indices_free.size();
+            _buffer_plan.resize(n_values);
+            _buffer_plan_transformed.resize(n_values);
+            for (size_t k = 0; k < n_values; ++k) {
+                _buffer_plan_transformed[k] = values_transformed[plan.indices_free[k]];
+            }
+            plan.transform->reverse_batch(_buffer_plan_transformed.data(), _buffer_plan.data(), n_values);
+            for (size_t k = 0; k < n_values; ++k) {
+                LSST_MODELFIT_PARAMETERS_COUNT(plan.parameters[k]->get_counters(), reverse);
+                const auto& limits = plan.parameters[k]->get_limits();
+                values[plan.indices_free[k]] = _buffer_plan[k];
+                at_limits[plan.indices_free[k]] = !limits.check(limits.wrap(_buffer_plan[k]));
+            }
+        }
+        _for_each_group([this, values_transformed, values, &at_limits](const TransformGroup& group,
+                                                                       const std::vector<size_t>& indices) {
+            const size_t n_values = indices.size();
+            _buffer_plan.resize(n_values);
+            _buffer_plan_transformed.resize(n_values);
+            for (size_t k = 0; k < n_values; ++k) {
+                _buffer_plan_transformed[k] = values_transformed[indices[k]];
+            }
+            group.transform->reverse(_buffer_plan_transformed.data(), _buffer_plan.data());
+            for (size_t k = 0; k < n_values; ++k) {
+                const auto& limits = _parameters[group.indices[k]]->get_limits();
+                values[indices[k]] = _buffer_plan[k];
+                at_limits[indices[k]] = !limits.check(limits.wrap(_buffer_plan[k]));
+            }
+        });
+        if (policy == LimitPolicy::error) _check_step(values, at_limits);
+
+        T penalty = 0;
+        for (const auto& plan : plans) {
+            const size_t n_values = plan.indices_free.size();
+            for (size_t k = 0; k < n_values; ++k) {
+                const size_t idx = plan.indices_free[k];
+                penalty += plan.parameters[k]->set_value_with_transformed(values[idx],
+                                                                          values_transformed[idx], policy);
+            }
+        }
+        _for_each_group([this, values, policy, &penalty](const TransformGroup& group,
+                                                         const std::vector<size_t>& indices) {
+            const size_t n_values = indices.size();
+            for (size_t k = 0; k < n_values; ++k) {
+                penalty += _parameters[group.indices[k]]->set_value(values[indices[k]], policy);
+            }
+        });
+        penalty += update_ties(policy);
+        return penalty;
+    }
+
+    /**
+     * Set the values of the free parameters to those of one of several
+     * candidate steps from evaluate_steps.
+     *
+     * @param candidates The candidates, which must be for the same free
+     *      parameters as this collection currently has.
+     * @param index The index of the candidate to set.
+     * @param policy The policy for untransformed values beyond limits.
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T commit_step(const StepCandidates& candidates, size_t index, LimitPolicy policy) {
+        const size_t n_free = get_n_free();
+        if (candidates.n_free != n_free) {
+            throw std::invalid_argument(this->str() + ".commit_step given candidates.n_free="
+                                        + std::to_string(candidates.n_free)
+                                        + " != n_free=" + std::to_string(n_free));
+        }
+        if (!(index < candidates.size())) {
+            throw std::out_of_range(this->str() + ".commit_step given index=" + std::to_string(index)
+                                    + " >= candidates.size()=" + std::to_string(candidates.size()));
+        }
+        const T* values = &candidates.values[index * n_free];
+        const T* values_transformed = &candidates.values_transformed[index * n_free];
+        T penalty = 0;
+        _for_each_free<true>([values, values_transformed, policy, &penalty](ParameterBase<T>& parameter,
+                                                                           size_t idx) {
+            penalty += parameter.set_value_with_transformed(values[idx], values_transformed[idx], policy);
+        });
+        _for_each_group([this, values, policy, &penalty](const TransformGroup& group,
+                                                         const std::vector<size_t>& indices) {
+            for (size_t k = 0; k < indices.size(); ++k) {
+                penalty += _parameters[group.indices[k]]->set_value(values[indices[k]], policy);
+            }
+        });
+        penalty += update_ties(policy);
+        return penalty;
+    }
+
+    /**
+     * Evaluate the values of the free parameters for steps of several
+     * lengths, without setting any values.
+     *
+     * @param direction The step direction in transformed space.
+     * @param alphas The step lengths of each candidate.
+     * @param candidates The candidates to write the (periodically-wrapped)
+     *      values and feasibility of each step to. Any existing storage is
+     *      reused.
+     */
+    void evaluate_steps(const std::vector<T>& direction, const std::vector<T>& alphas,
+                        StepCandidates& candidates) const {
+        const size_t n_free = get_n_free();
+        _check_size(direction, n_free, "direction");
+        const size_t n_alphas = alphas.size();
+        const size_t n_values = n_alphas * n_free;
+        candidates.n_free = n_free;
+        candidates.alphas = alphas;
+        candidates.values.resize(n_values);
+        candidates.values_transformed.resize(n_values);
+        candidates.feasible.resize(n_values);
+
+        _buffer.resize(n_free);
+        get_values_transformed(_buffer);
+        const T* start = _buffer.data();
+        T* values_transformed = candidates.values_transformed.data();
+        for (size_t k = 0; k < n_alphas; ++k) {
+            const T alpha = alphas[k];
+            T* row = &values_transformed[k * n_free];
+            for (size_t idx = 0; idx < n_free; ++idx) row[idx] = start[idx] + alpha * direction[idx];
+        }
+
+        T* values = candidates.values.data();
+        auto& feasible = candidates.feasible;
+        // Gather each parameter's candidates contiguously to reverse them in one batch call
+        _buffer_plan_transformed.resize(n_alphas);
+        _buffer_plan.resize(n_alphas);
+        T* column = _buffer_plan_transformed.data();
+        T* column_reversed = _buffer_plan.data();
+        _for_each_free<true>([&](const ParameterBase<T>& parameter, size_t idx) {
+            for (size_t k = 0; k < n_alphas; ++k) column[k] = values_transformed[k * n_free + idx];
+            const auto& transform = parameter.get_transform();
+            LSST_MODELFIT_PARAMETERS_COUNT_N(parameter.get_counters(), reverse, n_alphas);
+            transform.reverse_batch(column, column_reversed, n_alphas);
+            const auto& limits = parameter.get_limits();
+            for (size_t k = 0; k < n_alphas; ++k) {
+                const size_t offset = k * n_free + idx;
+                const T value = limits.wrap(column_reversed[k]);
+                values[offset] = value;
+                if (value != column_reversed[k]) values_transformed[offset] = transform.forward(value);
+                feasible[offset] = limits.check(value);
+            }
+        });
+        _for_each_group([&](const TransformGroup& group, const std::vector<size_t>& indices) {
+            const size_t n_group = indices.size();
+            for (size_t k = 0; k < n_alphas; ++k) {
+                for (size_t i = 0; i < n_group; ++i) {
+                    _buffer_group_transformed[i] = values_transformed[k * n_free + indices[i]];
+                }
+                group.transform->reverse(_buffer_group_transformed.data(), _buffer_group.data());
+                for (size_t i = 0; i < n_group; ++i) {
+                    const auto& limits = _parameters[group.indices[i]]->get_limits();
+                    const size_t offset = k * n_free + indices[i];
+                    values[offset] = limits.wrap(_buffer_group[i]);
+                    feasible[offset] = limits.check(values[offset]);
+                }
+            }
+        });
+    }
+
+    /// Add a step to the transformed values of the free parameters, with the default limit policy
+    T apply_step(const std::vector<T>& direction, T alpha) {
+        std::vector<bool> at_limits(get_n_free());
+        return apply_step(direction, alpha, _limit_policy, at_limits);
+    }
+
+    /**
+     * Return the log absolute determinant of the Jacobian of the transform
+     * of the free parameters, i.e. the sum of log|forward'(x)|.
+     *
+     * @note The log density of the transformed values is the log density
+     * of the untransformed values minus this.
+     */
+    T log_abs_det_jacobian() const {
+        T result = 0;
+        _for_each_free<true>([&result](const ParameterBase<T>& parameter, size_t) {
+            LSST_MODELFIT_PARAMETERS_COUNT(parameter.get_counters(), derivative);
+            result += parameter.get_transform().log_abs_derivative(parameter.get_value());
+        });
+        _for_each_group([this, &result](const TransformGroup& group, const std::vector<size_t>&) {
+            const size_t n_values = group.indices.size();
+            for (size_t k = 0; k < n_values; ++k) {
+                _buffer_group[k] = _parameters[group.indices[k]]->get_value();
+            }
+            result += group.transform->log_abs_det_jacobian(_buffer_group.data());
+        });
+        return result;
+    }
+
+    /**
+     * Compute log_abs_det_jacobian for many sets of untransformed values.
+     *
+     * @param values The untransformed values, ordered such that each free
+     *      parameter's values for every set are contiguous
+     *      (i.e. n_free x n_sets row-major).
+     * @param out The output log absolute determinant for each set, of
+     *      size n_sets.
+     */
+    void log_abs_det_jacobian(const std::vector<T>& values, std::vector<T>& out) const {
+        const size_t n_sets = out.size();
+        _check_size(values, get_n_free() * n_sets, "values");
+        std::fill(out.begin(), out.end(), 0);
+        _buffer_plan.resize(n_sets);
+        T* terms = _buffer_plan.data();
+        _for_each_free<true>([&values, &out, terms, n_sets](const ParameterBase<T>& parameter, size_t idx) {
+            LSST_MODELFIT_PARAMETERS_COUNT_N(parameter.get_counters(), derivative, n_sets);
+            parameter.get_transform().log_abs_derivative_batch(&values[idx * n_sets], terms, n_sets);
+            for (size_t i = 0; i < n_sets; ++i) out[i] += terms[i];
+        });
+        _for_each_group([this, &values, &out, terms, n_sets](const TransformGroup& group,
+                                                             const std::vector<size_t>& indices) {
+            // Gather the groups for every set contiguously for the batch method
+            const size_t n_values = indices.size();
+            _buffer_group.resize(std::max(_buffer_group.size(), n_values * n_sets));
+            T* values_group = _buffer_group.data();
+            for (size_t i = 0; i < n_sets; ++i) {
+                for (size_t k = 0; k < n_values; ++k) {
+                    values_group[i * n_values + k] = values[indices[k] * n_sets + i];
+                }
+            }
+            group.transform->log_abs_det_jacobian_batch(values_group, terms, n_sets);
+            for (size_t i = 0; i < n_sets; ++i) out[i] += terms[i];
+        });
+    }
+
+    /// Return the number of parameters, including fixed ones
+    size_t size() const { return _parameters.size(); }
+
+    /**
+     * Convert a gradient with respect to the untransformed values of the
+     * free parameters to one with respect to their transformed values.
+     *
+     * @param gradient The gradient to convert in place.
+     */
+    void transform_gradient(std::vector<T>& gradient) const {
+        _check_size(gradient, get_n_free(), "gradient");
+        _for_each_free<true>([&gradient](const ParameterBase<T>& parameter, size_t idx) {
+            gradient[idx] /= parameter.get_transform_derivative();
+        });
+        // dL/dy_j = sum_i dL/dx_i dx_i/dy_j
+        _for_each_group([this, &gradient](const TransformGroup& group, const std::vector<size_t>& indices) {
+            const size_t n_values = indices.size();
+            T* values_group = _buffer_group.data();
+            T* values_transformed = _buffer_group_transformed.data();
+            T* gradient_group = _buffer_group_other.data();
+            T* jacobian = _buffer_group_jacobian.data();
+            for (size_t k = 0; k < n_values; ++k) {
+                values_group[k] = _parameters[group.indices[k]]->get_value();
+                gradient_group[k] = gradient[indices[k]];
+            }
+            group.transform->forward(values_group, values_transformed);
+            group.transform->jacobian_reverse(values_transformed, jacobian);
+            for (size_t col = 0; col < n_values; ++col) {
+                T sum = 0;
+                for (size_t row = 0; row < n_values; ++row) {
+                    sum += gradient_group[row] * jacobian[row * n_values + col];
+                }
+                gradient[indices[col]] = sum;
+            }
+        });
+    }
+
+    /**
+     * Convert a dense Hessian with respect to the untransformed values of
+     * the free parameters to one with respect to their transformed values.
+     *
+     * @param hessian The row-major, n_free x n_free Hessian to convert in
+     *      place.
+     * @param gradient The untransformed gradient, which is needed for the
+     *      diagonal terms if any transform has a non-zero second derivative.
+     *
+     * @note With y = forward(x), d2L/dy_i dy_j = H_ij dx_i/dy_i dx_j/dy_j
+     *      + delta_ij g_i d2x_i/dy_i^2, where dx/dy = 1/forward'(x) and
+     *      d2x/dy2 = -forward''(x)/forward'(x)^3.
+     */
+    void transform_hessian(std::vector<T>& hessian, const std::vector<T>& gradient) const {
+        _check_no_groups("transform_hessian");
+        const size_t n_free = get_n_free();
+        _check_size(hessian, n_free * n_free, "hessian");
+        _check_size(gradient, n_free, "gradient");
+        _for_each_free([&hessian, &gradient, n_free](const ParameterBase<T>& parameter, size_t idx) {
+            LSST_MODELFIT_PARAMETERS_COUNT(parameter.get_counters(), derivative);
+            const auto& transform = parameter.get_transform();
+            const T value = parameter.get_value();
+            const T scale = 1 / transform.derivative(value);
+            // Scaling row and column idx by the same factor gives each
+            // element both of its factors once the loop is complete
+            T* row = &hessian[idx * n_free];
+            for (size_t col = 0; col < n_free; ++col) row[col] *= scale;
+            for (size_t row_idx = 0; row_idx < n_free; ++row_idx) hessian[row_idx * n_free + idx] *= scale;
+            if (gradient[idx] != 0) {
+                row[idx] -= gradient[idx] * transform.second_derivative(value) * scale * scale * scale;
+            }
+        });
+    }
+
+    /**
+     * Convert the diagonal of a Hessian with respect to the untransformed
+     * values of the free parameters to one with respect to their
+     * transformed values.
+     *
+     * @param diagonal The Hessian diagonal to convert in place.
+     * @param gradient The untransformed gradient.
+     *
+     * @see transform_hessian
+     */
+    void transform_hessian_diagonal(std::vector<T>& diagonal, const std::vector<T>& gradient) const {
+        _check_no_groups("transform_hessian_diagonal");
+        const size_t n_free = get_n_free();
+        _check_size(diagonal, n_free, "diagonal");
+        _check_size(gradient, n_free, "gradient");
+        _for_each_free([&diagonal, &gradient](const ParameterBase<T>& parameter, size_t idx) {
+            LSST_MODELFIT_PARAMETERS_COUNT(parameter.get_counters(), derivative);
+            const auto& transform = parameter.get_transform();
+            const T value = parameter.get_value();
+            const T scale = 1 / transform.derivative(value);
+            diagonal[idx] *= scale * scale;
+            if (gradient[idx] != 0) {
+                diagonal[idx] -= gradient[idx] * transform.second_derivative(value) * scale * scale * scale;
+            }
+        });
+    }
+
+    /**
+     * Tie a parameter's value to that of another in this collection.
+     *
+     * The dependent parameter's value is set to scale * (independent value)
+     * + offset immediately and whenever this collection sets values. A
+     * unit scale and zero offset shares a single value between parameters.
+     * If the dependent parameter is in this collection, it is no longer
+     * considered free.
+     *
+     * @param dependent The parameter to set.
+     * @param independent The parameter to set it from, which must be in this
+     *      collection and not be tied itself.
+     * @param scale The multiplicative factor.
+     * @param offset The additive offset.
+     *
+     * @note Gradients passed to this collection are with respect to the free
+     * parameters only, so any derivatives with respect to a dependent
+     * parameter must be multiplied by scale and added to the independent
+     * parameter's.
+     */
+    void tie(ParamPtr dependent, const ParameterBase<T>& independent, T scale = 1, T offset = 0) {
+        if (dependent == nullptr) throw std::invalid_argument(this->str() + " can't tie a null parameter");
+        const size_t index = get_index(independent);
+        for (const auto& group : _groups) {
+            for (size_t idx : group.indices) {
+                if (*_parameters[idx] == *dependent) {
+                    throw std::invalid_argument(this->str() + " can't tie " + dependent->str()
+                                                + ", which is in a vector transform group");
+                }
+            }
+        }
+        if (*dependent == independent) {
+            throw std::invalid_argument(this->str() + " can't tie " + independent.str() + " to itself");
+        }
+        if (_is_dependent[index]) {
+            throw std::invalid_argument(this->str() + " can't tie to already-tied " + independent.str());
+        }
+        for (const auto& tie_existing : _ties) {
+            if (*tie_existing.dependent == *dependent) {
+                throw std::invalid_argument(this->str() + " can't tie already-tied " + dependent->str());
+            }
+            if (*_parameters[tie_existing.index] == *dependent) {
+                throw std::invalid_argument(this->str() + " can't tie " + dependent->str()
+                                            + ", which has parameters tied to it");
+            }
+        }
+        dependent->set_value(scale * independent.get_value() + offset);
+        const size_t n_params = _parameters.size();
+        for (size_t idx = 0; idx < n_params; ++idx) {
+            if (*_parameters[idx] == *dependent) _is_dependent[idx] = true;
+        }
+        _ties.push_back({std::move(dependent), index, scale, offset});
+        ++_version_structure;
+    }
+
+    /// Remove any tie setting the value of a parameter
+    void untie(const ParameterBase<T>& dependent) {
+        for (auto tie_it = _ties.begin(); tie_it != _ties.end(); ++tie_it) {
+            if (*tie_it->dependent == dependent) {
+                _ties.erase(tie_it);
+                const size_t n_params = _parameters.size();
+                for (size_t idx = 0; idx < n_params; ++idx) {
+                    if (*_parameters[idx] == dependent) _is_dependent[idx] = false;
+                }
+                ++_version_structure;
+                return;
+            }
+        }
+    }
+
+    /**
+     * Set the values of all tied parameters from their independent parameters.
+     *
+     * @return The total penalty if the limit policy is LimitPolicy::penalize,
+     *      or else zero.
+     */
+    T update_ties() { return update_ties(_limit_policy); }
+    /// Set the values of all tied parameters from their independent parameters with a given limit policy
+    T update_ties(LimitPolicy policy) {
+        T penalty = 0;
+        for (auto& tie : _ties) {
+            penalty += tie.dependent->set_value(tie.scale * _parameters[tie.index]->get_value() + tie.offset,
+                                                policy);
+        }
+        return penalty;
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        std::string result = type_name_str<ParameterCollection<T>>(false, namespace_separator) + "("
+                             + (name_keywords ? "parameters=" : "") + "[";
+        for (const auto& parameter : _parameters) {
+            result += parameter->repr(name_keywords, namespace_separator) + ", ";
+        }
+        return result + "])";
+    }
+
+    std::string str() const override {
+        return type_name_str<ParameterCollection<T>>(true) + "(size=" + std::to_string(_parameters.size())
+               + ")";
+    }
+
+    /**
+     * Initialize a ParameterCollection.
+     *
+     * @param parameters The parameters to add, in order.
+     */
+    explicit ParameterCollection(std::vector<ParamPtr> parameters = {}) {
+        _parameters.reserve(parameters.size());
+        _indices.reserve(parameters.size());
+        for (auto& parameter : parameters) add(std::move(parameter));
+    }
+    ~ParameterCollection(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_COLLECTION_H
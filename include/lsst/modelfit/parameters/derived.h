@@ -0,0 +1,264 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_DERIVED_H
+#define LSST_MODELFIT_PARAMETERS_DERIVED_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "object.h"
+#include "parameter.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A value computed from the values of other parameters.
+ *
+ * The value and its derivatives with respect to the inputs are cached and
+ * only recomputed when the version (see ParameterBase::get_version) of any
+ * input has changed since they were last computed.
+ *
+ * Other DerivedParameters may also be inputs, so that derived values can be
+ * chained (e.g. flux to magnitude to colour). Their values follow those of
+ * any parameter inputs.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ *
+ * @note The caches are not synchronized, so a DerivedParameter should not
+ * be read from multiple threads at once.
+ */
+template <typename T>
+class DerivedParameter : public Object {
+public:
+    using Inputs = std::vector<std::shared_ptr<const ParameterBase<T>>>;
+    using InputsDerived = std::vector<std::shared_ptr<const DerivedParameter<T>>>;
+    /// A function returning the value given the input values
+    using Function = std::function<T(const std::vector<T>&)>;
+    /// A function writing the derivatives given the input values
+    using Gradient = std::function<void(const std::vector<T>&, std::vector<T>&)>;
+
+private:
+    Inputs _inputs;
+    InputsDerived _inputs_derived;
+    Function _func;
+    Gradient _gradient_func;
+    std::string _label;
+
+    mutable std::vector<T> _values;
+    mutable std::vector<uint64_t> _versions;
+    /// The number of times the value may have changed
+    mutable uint64_t _version = 0;
+    mutable T _value = 0;
+    mutable std::vector<T> _derivatives;
+    mutable bool _valid_value = false;
+    mutable bool _valid_derivatives = false;
+
+    /// Refresh an input value and return whether it has changed
+    template <typename Input>
+    bool _update_input(const Input& input, size_t idx) const {
+        const uint64_t version = input.get_version();
+        if (version == _versions[idx]) return false;
+        _versions[idx] = version;
+        _values[idx] = input.get_value();
+        return true;
+    }
+
+    /// Refresh the input values and invalidate caches if any have changed
+    void _update_inputs() const {
+        bool changed = false;
+        const size_t n_inputs = _inputs.size();
+        for (size_t idx = 0; idx < n_inputs; ++idx) changed |= _update_input(*_inputs[idx], idx);
+        const size_t n_derived = _inputs_derived.size();
+        for (size_t idx = 0; idx < n_derived; ++idx) {
+            changed |= _update_input(*_inputs_derived[idx], n_inputs + idx);
+        }
+        if (changed) {
+            _valid_value = false;
+            _valid_derivatives = false;
+            ++_version;
+        }
+    }
+
+    /// Compute derivatives with central finite differences
+    void _compute_derivatives_numeric() const {
+        auto values = _values;
+        const size_t n_inputs = _values.size();
+        for (size_t idx = 0; idx < n_inputs; ++idx) {
+            const T value = _values[idx];
+            const T step = std::sqrt(std::numeric_limits<T>::epsilon()) * std::max(std::abs(value), T(1));
+            values[idx] = value + step;
+            const T value_hi = _func(values);
+            values[idx] = value - step;
+            const T value_lo = _func(values);
+            values[idx] = value;
+            _derivatives[idx] = (value_hi - value_lo) / (2 * step);
+        }
+    }
+
+public:
+    /**
+     * Return the derivatives of the value with respect to each input.
+     *
+     * Derivatives with respect to parameter inputs are followed by those with
+     * respect to derived inputs.
+     *
+     * @return The derivatives, which are computed with the gradient function
+     *      if one was provided and central finite differences otherwise.
+     */
+    const std::vector<T>& get_derivatives() const {
+        _update_inputs();
+        if (!_valid_derivatives) {
+            if (_gradient_func) {
+                _gradient_func(_values, _derivatives);
+            } else {
+                _compute_derivatives_numeric();
+            }
+            _valid_derivatives = true;
+        }
+        return _derivatives;
+    }
+
+    /// Return the input parameters
+    const Inputs& get_inputs() const { return _inputs; }
+    /// Return the derived inputs
+    const InputsDerived& get_inputs_derived() const { return _inputs_derived; }
+
+    /// Return the string label for this instance
+    const std::string& get_label() const { return _label; }
+
+    /// Return whether the cached value is stale, i.e. any input has changed
+    bool get_stale() const {
+        if (!_valid_value) return true;
+        const size_t n_inputs = _inputs.size();
+        for (size_t idx = 0; idx < n_inputs; ++idx) {
+            if (_inputs[idx]->get_version() != _versions[idx]) return true;
+        }
+        const size_t n_derived = _inputs_derived.size();
+        for (size_t idx = 0; idx < n_derived; ++idx) {
+            if (_inputs_derived[idx]->get_version() != _versions[n_inputs + idx]) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Return a version number that changes whenever the value may have
+     * changed, i.e. if any input has changed or the cache was invalidated.
+     */
+    uint64_t get_version() const {
+        _update_inputs();
+        return _version;
+    }
+
+    /// Return the value, computing it only if any input has changed
+    T get_value() const {
+        _update_inputs();
+        if (!_valid_value) {
+            _value = _func(_values);
+            _valid_value = true;
+        }
+        return _value;
+    }
+
+    /// Invalidate the cached value and derivatives, e.g. if the function has external state
+    void invalidate() {
+        _valid_value = false;
+        _valid_derivatives = false;
+        ++_version;
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        std::string result = type_name_str<DerivedParameter<T>>(false, namespace_separator) + "("
+                             + (name_keywords ? "inputs=" : "") + "[";
+        for (const auto& input : _inputs) result += input->repr(name_keywords, namespace_separator) + ", ";
+        result += std::string("], ") + (name_keywords ? "inputs_derived=" : "") + "[";
+        for (const auto& input : _inputs_derived) {
+            result += input->repr(name_keywords, namespace_separator) + ", ";
+        }
+        return result + "], " + (name_keywords ? "label='" : "'") + _label + "')";
+    }
+
+    std::string str() const override {
+        std::string result = type_name_str<DerivedParameter<T>>(true) + "(inputs=[";
+        for (const auto& input : _inputs) result += input->str() + ", ";
+        result += "], inputs_derived=[";
+        for (const auto& input : _inputs_derived) result += input->str() + ", ";
+        return result + "], label='" + _label + "')";
+    }
+
+    /**
+     * Initialize a DerivedParameter.
+     *
+     * @param inputs The parameters that the value depends on.
+     * @param func The function returning the value given the input values,
+     *      with the values of parameter inputs followed by derived inputs.
+     * @param gradient The function writing the derivatives of the value
+     *      with respect to each input, given the input values. If null,
+     *      derivatives are computed with finite differences.
+     * @param label A descriptive label for the parameter.
+     * @param inputs_derived Other DerivedParameters that the value depends on.
+     */
+    DerivedParameter(Inputs inputs, Function func, Gradient gradient = nullptr, std::string label = "",
+                     InputsDerived inputs_derived = {})
+            : _inputs(std::move(inputs)),
+              _inputs_derived(std::move(inputs_derived)),
+              _func(std::move(func)),
+              _gradient_func(std::move(gradient)),
+              _label(std::move(label)) {
+        if (!_func) throw std::invalid_argument("DerivedParameter can't be initialized with a null func");
+        const size_t n_inputs = _inputs.size();
+        const size_t n_total = n_inputs + _inputs_derived.size();
+        _values.resize(n_total);
+        _versions.resize(n_total);
+        _derivatives.resize(n_total);
+        for (size_t idx = 0; idx < n_inputs; ++idx) {
+            if (_inputs[idx] == nullptr) {
+                throw std::invalid_argument("DerivedParameter can't be initialized with a null input");
+            }
+            _versions[idx] = _inputs[idx]->get_version();
+            _values[idx] = _inputs[idx]->get_value();
+        }
+        for (size_t idx = n_inputs; idx < n_total; ++idx) {
+            const auto& input = _inputs_derived[idx - n_inputs];
+            if (input == nullptr) {
+                throw std::invalid_argument("DerivedParameter can't be initialized with null derived inputs");
+            }
+            _versions[idx] = input->get_version();
+            _values[idx] = input->get_value();
+        }
+    }
+    ~DerivedParameter(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_DERIVED_H
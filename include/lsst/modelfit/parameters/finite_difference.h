@@ -0,0 +1,335 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_FINITE_DIFFERENCE_H
+#define LSST_MODELFIT_PARAMETERS_FINITE_DIFFERENCE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "collection.h"
+#include "object.h"
+#include "parameter.h"
+#include "parameter_map.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief Computes the Jacobian of a function of the parameters of a
+ * ParameterCollection with respect to their transformed values by finite
+ * differences.
+ *
+ * The step for each parameter is a relative step times the larger of the
+ * magnitude of its transformed value and a per-parameter scale hint.
+ * Central differences are used unless a step would leave the transformed
+ * value's limits, in which case a one-sided step is taken away from the
+ * nearer bound, shortened to the distance to the farther bound if needed.
+ *
+ * The function is evaluated on perturbed copies of the untransformed values
+ * of all of the collection's parameters (including fixed ones), so the
+ * parameters themselves are never set. Perturbed values are wrapped into
+ * periodic limits, and the values of parameters in the collection that are
+ * tied to a perturbed parameter are updated (and wrapped) in the copy.
+ * Columns are computed on worker threads, so the function must be safe to
+ * call concurrently if more than one thread is used.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+class FiniteDifference : public Object {
+public:
+    using ParamPtr = std::shared_ptr<ParameterBase<T>>;
+    /// A function writing n_output values given the untransformed values of the collection's parameters
+    using Function = std::function<void(const std::vector<T>& values, std::vector<T>& output)>;
+
+    /// The kind of difference taken for a parameter
+    enum class Step { central, forward, backward };
+
+private:
+    const ParameterCollection<T>& _collection;
+    Function _function;
+    size_t _n_output;
+    size_t _n_threads;
+    /// The scale hint for each parameter, if not the default of one
+    ParameterMap<T, T> _scales;
+
+    std::vector<ParamPtr> _get_free() const {
+        if (!_collection.get_vector_transforms().empty()) {
+            throw std::logic_error(this->str() + " does not support collections with vector transforms");
+        }
+        return _collection.get_parameters_free();
+    }
+
+    void _compute_steps(const std::vector<ParamPtr>& free, std::vector<T>& steps,
+                        std::vector<Step>& kinds) const {
+        const size_t n_free = free.size();
+        steps.resize(n_free);
+        kinds.resize(n_free);
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            const auto& parameter = *free[idx];
+            const T value = parameter.get_value_transformed();
+            const T magnitude = std::max(std::abs(value), get_scale(parameter));
+            const auto& limits = parameter.get_limits_transformed();
+            const T distance_lower = value - limits.get_min();
+            const T distance_upper = limits.get_max() - value;
+            T step = get_step_central() * magnitude;
+            if ((step <= distance_lower) && (step <= distance_upper)) {
+                kinds[idx] = Step::central;
+            } else {
+                step = get_step_one_sided() * magnitude;
+                if (distance_upper >= distance_lower) {
+                    kinds[idx] = Step::forward;
+                    step = std::min(step, distance_upper);
+                } else {
+                    kinds[idx] = Step::backward;
+                    step = std::min(step, distance_lower);
+                }
+            }
+            // Use the step that is exactly representable after adding it to the value
+            steps[idx] = (value + step) - value;
+        }
+    }
+
+    void _check_output(const std::vector<T>& output) const {
+        if (output.size() != _n_output) {
+            throw std::runtime_error(this->str() + " function returned output.size()="
+                                     + std::to_string(output.size()) + " != n_output="
+                                     + std::to_string(_n_output));
+        }
+    }
+
+public:
+    /**
+     * Compute the Jacobian of the function at the current values.
+     *
+     * @param jacobian The output Jacobian, of size n_output * n_free, in
+     *      column-major order (i.e. the derivatives of all outputs with
+     *      respect to each free parameter are contiguous). Columns for
+     *      parameters with a step of zero (e.g. with equal limits) are zero.
+     * @param output The function's output at the current values, which is
+     *      resized and is only computed if not null or if needed for
+     *      one-sided differences.
+     */
+    void compute_jacobian(std::vector<T>& jacobian, std::vector<T>* output = nullptr) const {
+        const auto free = _get_free();
+        const size_t n_free = free.size();
+        if (jacobian.size() != n_free * _n_output) {
+            throw std::invalid_argument(this->str() + " given jacobian.size()="
+                                        + std::to_string(jacobian.size())
+                                        + " != n_output*n_free=" + std::to_string(n_free * _n_output));
+        }
+        std::vector<T> steps;
+        std::vector<Step> kinds;
+        _compute_steps(free, steps, kinds);
+
+        const auto& parameters = _collection.get_parameters();
+        const auto& is_dependent = _collection.get_is_dependent();
+        const size_t n_params = parameters.size();
+        std::vector<T> values(n_params), values_transformed(n_free);
+        // The index in the collection of each free parameter
+        std::vector<size_t> indices(n_free);
+        for (size_t index = 0, idx = 0; index < n_params; ++index) {
+            values[index] = parameters[index]->get_value();
+            if (parameters[index]->get_free() && !is_dependent[index]) {
+                indices[idx] = index;
+                values_transformed[idx] = parameters[index]->get_value_transformed();
+                ++idx;
+            }
+        }
+        // The ties with dependents in the collection, by the index of the dependent
+        std::vector<std::pair<size_t, const typename ParameterCollection<T>::Tie*>> ties;
+        for (const auto& tie : _collection.get_ties()) {
+            if (_collection.contains(*tie.dependent)) {
+                ties.emplace_back(_collection.get_index(*tie.dependent), &tie);
+            }
+        }
+        // Set tied values in a copy of the values from a given independent parameter's
+        auto update_ties = [&ties, &parameters](std::vector<T>& values_copy, size_t index) {
+            for (const auto& [index_dependent, tie] : ties) {
+                if (tie->index == index) {
+                    values_copy[index_dependent] = parameters[index_dependent]->get_limits().wrap(
+                            tie->scale * values_copy[index] + tie->offset);
+                }
+            }
+        };
+        for (size_t idx = 0; idx < n_free; ++idx) update_ties(values, indices[idx]);
+
+        std::vector<T> output_base;
+        const bool one_sided = std::any_of(kinds.begin(), kinds.end(),
+                                           [](Step kind) { return kind != Step::central; });
+        if ((output != nullptr) || one_sided) {
+            output_base.resize(_n_output);
+            _function(values, output_base);
+            _check_output(output_base);
+        }
+
+        const size_t n_threads = std::max(size_t(1), std::min(_n_threads, n_free));
+        auto compute_columns = [&](size_t idx_thread) {
+            // Each thread perturbs its own copy of the values
+            std::vector<T> values_perturbed(values);
+            std::vector<T> output_plus(_n_output), output_minus(_n_output);
+            auto perturb = [&](size_t idx, T value_transformed) {
+                const auto& parameter = *free[idx];
+                values_perturbed[indices[idx]]
+                        = parameter.get_limits().wrap(parameter.get_transform().reverse(value_transformed));
+                update_ties(values_perturbed, indices[idx]);
+            };
+            for (size_t idx = idx_thread; idx < n_free; idx += n_threads) {
+                T* column = jacobian.data() + idx * _n_output;
+                const T step = steps[idx];
+                if (!(step > 0)) {
+                    std::fill(column, column + _n_output, T(0));
+                    continue;
+                }
+                const T value_transformed = values_transformed[idx];
+                const Step kind = kinds[idx];
+                if (kind != Step::backward) {
+                    perturb(idx, value_transformed + step);
+                    _function(values_perturbed, output_plus);
+                    _check_output(output_plus);
+                }
+                if (kind != Step::forward) {
+                    perturb(idx, value_transformed - step);
+                    _function(values_perturbed, output_minus);
+                    _check_output(output_minus);
+                }
+                values_perturbed[indices[idx]] = values[indices[idx]];
+                update_ties(values_perturbed, indices[idx]);
+                const T* plus = (kind == Step::backward) ? output_base.data() : output_plus.data();
+                const T* minus = (kind == Step::forward) ? output_base.data() : output_minus.data();
+                const T denominator = (kind == Step::central) ? 2 * step : step;
+                for (size_t idx_out = 0; idx_out < _n_output; ++idx_out) {
+                    column[idx_out] = (plus[idx_out] - minus[idx_out]) / denominator;
+                }
+            }
+        };
+
+        std::vector<std::exception_ptr> errors(n_threads);
+        auto compute_columns_safe = [&compute_columns, &errors](size_t idx_thread) {
+            try {
+                compute_columns(idx_thread);
+            } catch (...) {
+                errors[idx_thread] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(n_threads - 1);
+        for (size_t idx_thread = 1; idx_thread < n_threads; ++idx_thread) {
+            threads.emplace_back(compute_columns_safe, idx_thread);
+        }
+        compute_columns_safe(0);
+        for (auto& thread : threads) thread.join();
+        for (const auto& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        if (output != nullptr) *output = std::move(output_base);
+    }
+
+    /**
+     * Compute the step and kind of difference for each free parameter.
+     *
+     * @param steps The output steps in transformed values, which are resized.
+     * @param kinds The output kinds of difference, which are resized.
+     */
+    void compute_steps(std::vector<T>& steps, std::vector<Step>& kinds) const {
+        _compute_steps(_get_free(), steps, kinds);
+    }
+
+    /// Return the number of outputs of the function
+    size_t get_n_output() const { return _n_output; }
+    /// Return the maximum number of threads to compute columns with
+    size_t get_n_threads() const { return _n_threads; }
+    /// Return the scale hint for a parameter, which is one by default
+    T get_scale(const ParameterBase<T>& parameter) const {
+        return _scales.contains(parameter) ? _scales.at(parameter) : T(1);
+    }
+    /// Return the relative step for central differences
+    static T get_step_central() { return std::cbrt(std::numeric_limits<T>::epsilon()); }
+    /// Return the relative step for one-sided differences
+    static T get_step_one_sided() { return std::sqrt(std::numeric_limits<T>::epsilon()); }
+
+    /// Set the maximum number of threads to compute columns with, or zero for the hardware concurrency
+    void set_n_threads(size_t n_threads) {
+        _n_threads = n_threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : n_threads;
+    }
+    /**
+     * Set the scale hint for a parameter.
+     *
+     * @param parameter The parameter.
+     * @param scale The typical magnitude of changes in the parameter's
+     *      transformed value, which must be positive and finite.
+     */
+    void set_scale(const ParameterBase<T>& parameter, T scale) {
+        if (!(std::isfinite(scale) && (scale > 0))) {
+            throw std::invalid_argument(this->str() + " given invalid scale=" + std::to_string(scale)
+                                        + " for " + parameter.str());
+        }
+        _scales.set(parameter, scale);
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<FiniteDifference<T>>(false, namespace_separator) + "("
+               + (name_keywords ? "collection=" : "") + _collection.repr(name_keywords, namespace_separator)
+               + ", " + (name_keywords ? "n_output=" : "") + std::to_string(_n_output) + ", "
+               + (name_keywords ? "n_threads=" : "") + std::to_string(_n_threads) + ")";
+    }
+
+    std::string str() const override {
+        return type_name_str<FiniteDifference<T>>(true) + "(n_output=" + std::to_string(_n_output)
+               + ", n_threads=" + std::to_string(_n_threads) + ")";
+    }
+
+    /**
+     * Initialize a FiniteDifference.
+     *
+     * @param collection The collection to differentiate with respect to,
+     *      which must outlive this.
+     * @param function The function to differentiate.
+     * @param n_output The number of outputs of the function.
+     * @param n_threads The maximum number of threads to compute columns
+     *      with, or zero for the hardware concurrency.
+     */
+    FiniteDifference(const ParameterCollection<T>& collection, Function function, size_t n_output,
+                     size_t n_threads = 1)
+            : _collection(collection), _function(std::move(function)), _n_output(n_output), _n_threads(1) {
+        if (!_function) throw std::invalid_argument(this->str() + " given null function");
+        set_n_threads(n_threads);
+    }
+    ~FiniteDifference(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_FINITE_DIFFERENCE_H
@@ -0,0 +1,288 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_FIT_SCHEDULE_H
+#define LSST_MODELFIT_PARAMETERS_FIT_SCHEDULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "collection.h"
+#include "limits.h"
+#include "object.h"
+#include "parameter.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A sequence of fitting stages, each freeing a subset of the
+ * parameters of a ParameterCollection.
+ *
+ * The free mask and the indices of the free (and untied) parameters are
+ * precomputed for each stage, so switching stages only swaps the current
+ * stage and calls set_free on the parameters whose status differs from the
+ * previous stage. Values are gathered and scattered with the current
+ * stage's cached indices, in the same order as the collection's free values.
+ *
+ * Stages are recomputed when switching to one after the collection adds
+ * parameters or changes ties; parameters added after a stage are fixed in
+ * it. Values can't be gathered or scattered after such changes, or if any
+ * parameter's free status no longer matches the current stage, until a
+ * stage is set again.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+class FitSchedule : public Object {
+public:
+    using ParamPtr = std::shared_ptr<ParameterBase<T>>;
+
+    /// A fitting stage
+    struct Stage {
+        std::string name;
+        /// Whether each parameter in the collection is free
+        std::vector<bool> free;
+        /// The index in the collection of each free and untied parameter
+        std::vector<size_t> indices_free;
+    };
+
+private:
+    ParameterCollection<T>& _collection;
+    std::vector<Stage> _stages;
+    /// The index of the current stage, or _stages.size() if none is set
+    size_t _index_stage = 0;
+    /// ParameterBase::get_structure_epoch() when the current stage was last known to be applied
+    mutable uint64_t _epoch = 0;
+    /// ParameterCollection::get_structure_version() when the current stage was set
+    uint64_t _version_applied = 0;
+    /// ParameterCollection::get_structure_version() when stages were computed
+    uint64_t _version_stages = 0;
+
+    /// Recompute each stage's free indices
+    void _compute_stages() {
+        if (!_collection.get_vector_transforms().empty()) {
+            throw std::logic_error(this->str() + " does not support collections with vector transforms");
+        }
+        const auto& is_dependent = _collection.get_is_dependent();
+        const size_t n_params = _collection.size();
+        for (auto& stage : _stages) {
+            stage.free.resize(n_params, false);
+            stage.indices_free.clear();
+            for (size_t idx = 0; idx < n_params; ++idx) {
+                if (stage.free[idx] && !is_dependent[idx]) stage.indices_free.push_back(idx);
+            }
+        }
+        _version_stages = _collection.get_structure_version();
+    }
+
+    /// Recompute each stage's free indices if the collection has changed
+    void _refresh() {
+        if (_version_stages != _collection.get_structure_version()) _compute_stages();
+    }
+
+    /// Return whether the current stage is still applied, i.e. free statuses match its mask
+    bool _is_applied() const {
+        if (_version_applied != _collection.get_structure_version()) return false;
+        const uint64_t epoch = ParameterBase<T>::get_structure_epoch();
+        if (_epoch == epoch) return true;
+        // The epoch is global, so check whether this collection's free statuses changed
+        const auto& parameters = _collection.get_parameters();
+        const auto& free = _stages[_index_stage].free;
+        const size_t n_params = parameters.size();
+        for (size_t idx = 0; idx < n_params; ++idx) {
+            if (parameters[idx]->get_free() != free[idx]) return false;
+        }
+        _epoch = epoch;
+        return true;
+    }
+
+    const Stage& _get_current() const {
+        if (_index_stage == _stages.size()) throw std::logic_error(this->str() + " has no stage set");
+        if (!_is_applied()) {
+            throw std::logic_error(this->str() + " collection or free parameters have changed;"
+                                   " call set_stage again");
+        }
+        return _stages[_index_stage];
+    }
+
+    void _check_size(const std::vector<T>& values, size_t size) const {
+        if (values.size() != size) {
+            throw std::invalid_argument(this->str() + " given values.size()=" + std::to_string(values.size())
+                                        + " != n_free=" + std::to_string(size));
+        }
+    }
+
+public:
+    /**
+     * Add a stage to the end of the schedule.
+     *
+     * @param name A name for the stage.
+     * @param parameters_free The parameters to free in this stage, which must
+     *      be in the collection. All others are fixed.
+     * @return The index of the new stage.
+     */
+    size_t add_stage(std::string name, const std::vector<ParamPtr>& parameters_free) {
+        const bool is_unset = _index_stage == _stages.size();
+        std::vector<bool> free(_collection.size(), false);
+        for (const auto& parameter : parameters_free) {
+            if (parameter == nullptr) throw std::invalid_argument(this->str() + " given null parameter");
+            free[_collection.get_index(*parameter)] = true;
+        }
+        _stages.push_back({std::move(name), std::move(free), {}});
+        if (is_unset) _index_stage = _stages.size();
+        _compute_stages();
+        return _stages.size() - 1;
+    }
+
+    /// Return the number of free parameters in the current stage
+    size_t get_n_free() const { return _get_current().indices_free.size(); }
+    /// Return the number of stages
+    size_t get_n_stages() const { return _stages.size(); }
+    /// Return the stage at a given index
+    const Stage& get_stage(size_t index) const { return _stages.at(index); }
+    /// Return the index of the current stage, or get_n_stages() if none has been set
+    size_t get_stage_index() const { return _index_stage; }
+
+    /// Write the untransformed values of the current stage's free parameters to values
+    void get_values(std::vector<T>& values) const {
+        const auto& indices = _get_current().indices_free;
+        _check_size(values, indices.size());
+        const auto& parameters = _collection.get_parameters();
+        const size_t n_free = indices.size();
+        for (size_t idx = 0; idx < n_free; ++idx) values[idx] = parameters[indices[idx]]->get_value();
+    }
+
+    /// Write the transformed values of the current stage's free parameters to values
+    void get_values_transformed(std::vector<T>& values) const {
+        const auto& indices = _get_current().indices_free;
+        _check_size(values, indices.size());
+        const auto& parameters = _collection.get_parameters();
+        const size_t n_free = indices.size();
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            values[idx] = parameters[indices[idx]]->get_value_transformed();
+        }
+    }
+
+    /**
+     * Switch to a stage, setting the free status of parameters.
+     *
+     * Only parameters whose status differs from the previous stage are set,
+     * unless any parameter's free status or transform or the collection
+     * was changed since it was set, in which case every parameter's status
+     * is checked.
+     *
+     * @param index The index of the stage.
+     */
+    void set_stage(size_t index) {
+        if (!(index < _stages.size())) {
+            throw std::out_of_range(this->str() + " given stage index=" + std::to_string(index));
+        }
+        _refresh();
+        const auto& parameters = _collection.get_parameters();
+        const auto& free = _stages[index].free;
+        const size_t n_params = parameters.size();
+        if ((_index_stage < _stages.size()) && (_version_applied == _collection.get_structure_version())
+            && (_epoch == ParameterBase<T>::get_structure_epoch())) {
+            const auto& free_previous = _stages[_index_stage].free;
+            for (size_t idx = 0; idx < n_params; ++idx) {
+                if (free[idx] != free_previous[idx]) parameters[idx]->set_free(free[idx]);
+            }
+        } else {
+            for (size_t idx = 0; idx < n_params; ++idx) {
+                if (parameters[idx]->get_free() != free[idx]) parameters[idx]->set_free(free[idx]);
+            }
+        }
+        _index_stage = index;
+        _epoch = ParameterBase<T>::get_structure_epoch();
+        _version_applied = _collection.get_structure_version();
+    }
+
+    /**
+     * Set the untransformed values of the current stage's free parameters
+     * and update ties.
+     *
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T set_values(const std::vector<T>& values, LimitPolicy policy = LimitPolicy::error) {
+        const auto& indices = _get_current().indices_free;
+        _check_size(values, indices.size());
+        const auto& parameters = _collection.get_parameters();
+        const size_t n_free = indices.size();
+        T penalty = 0;
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            penalty += parameters[indices[idx]]->set_value(values[idx], policy);
+        }
+        penalty += _collection.update_ties(policy);
+        return penalty;
+    }
+
+    /**
+     * Set the transformed values of the current stage's free parameters
+     * and update ties.
+     *
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T set_values_transformed(const std::vector<T>& values, LimitPolicy policy = LimitPolicy::error) {
+        const auto& indices = _get_current().indices_free;
+        _check_size(values, indices.size());
+        const auto& parameters = _collection.get_parameters();
+        const size_t n_free = indices.size();
+        T penalty = 0;
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            penalty += parameters[indices[idx]]->set_value_transformed(values[idx], policy);
+        }
+        penalty += _collection.update_ties(policy);
+        return penalty;
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        std::string stages = "[";
+        for (const auto& stage : _stages) stages += "'" + stage.name + "', ";
+        return type_name_str<FitSchedule<T>>(false, namespace_separator) + "("
+               + (name_keywords ? "collection=" : "") + _collection.repr(name_keywords, namespace_separator)
+               + ", " + (name_keywords ? "stages=" : "") + stages + "])";
+    }
+
+    std::string str() const override {
+        return type_name_str<FitSchedule<T>>(true) + "(n_stages=" + std::to_string(_stages.size())
+               + ", stage=" + std::to_string(_index_stage) + ")";
+    }
+
+    /**
+     * Initialize a FitSchedule with no stages.
+     *
+     * @param collection The collection to schedule, which must outlive this.
+     */
+    explicit FitSchedule(ParameterCollection<T>& collection) : _collection(collection) {}
+    ~FitSchedule(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_FIT_SCHEDULE_H
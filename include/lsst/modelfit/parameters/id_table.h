@@ -0,0 +1,159 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_ID_TABLE_H
+#define LSST_MODELFIT_PARAMETERS_ID_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace lsst::modelfit::parameters {
+
+namespace detail {
+
+/**
+ * @brief An open-addressing hash table of values keyed by parameter id.
+ *
+ * Slots are probed linearly from the Fibonacci hash of the id, the load
+ * factor is kept at most 1/2 and erased entries are removed by backward
+ * shifting, so lookups never need tombstones. This is the storage behind
+ * ParameterMap and ParameterSet.
+ *
+ * @tparam V The type of the values stored for each id.
+ */
+template <typename V>
+class IdTable {
+private:
+    struct Slot {
+        size_t id = 0;
+        bool used = false;
+        V value = V();
+    };
+
+    /// The hash table, whose size is zero or a power of two
+    std::vector<Slot> _slots;
+    size_t _size = 0;
+
+    /// Return the first slot to probe for an id, by Fibonacci hashing
+    size_t _hash(size_t id) const {
+        return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >> 32)
+               & (_slots.size() - 1);
+    }
+
+    /// Return the slot holding an id or else the empty slot where it would be inserted
+    size_t _find_slot(size_t id) const {
+        const size_t mask = _slots.size() - 1;
+        size_t slot = _hash(id);
+        while (_slots[slot].used && (_slots[slot].id != id)) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    /// Rebuild the hash table with at least n_slots slots
+    void _rehash(size_t n_slots) {
+        size_t size = 16;
+        while (size < n_slots) size *= 2;
+        std::vector<Slot> slots(size);
+        std::swap(slots, _slots);
+        for (auto& slot : slots) {
+            if (slot.used) _slots[_find_slot(slot.id)] = std::move(slot);
+        }
+    }
+
+public:
+    /// Return the number of allocated slots, which is at least twice size()
+    size_t capacity() const { return _slots.size(); }
+
+    /// Remove all values, keeping the allocated slots
+    void clear() {
+        std::fill(_slots.begin(), _slots.end(), Slot());
+        _size = 0;
+    }
+
+    /// Remove the value for an id, returning whether it had one
+    bool erase(size_t id) {
+        if (_slots.empty()) return false;
+        const size_t mask = _slots.size() - 1;
+        size_t hole = _find_slot(id);
+        if (!_slots[hole].used) return false;
+        size_t slot = hole;
+        while (true) {
+            slot = (slot + 1) & mask;
+            if (!_slots[slot].used) break;
+            // Move this entry into the hole unless its home slot lies cyclically in (hole, slot]
+            const size_t home = _hash(_slots[slot].id);
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                _slots[hole] = std::move(_slots[slot]);
+                hole = slot;
+            }
+        }
+        _slots[hole] = Slot();
+        --_size;
+        return true;
+    }
+
+    /// Return a pointer to the value for an id, or nullptr if it has none
+    const V* find(size_t id) const {
+        if (_slots.empty()) return nullptr;
+        const Slot& slot = _slots[_find_slot(id)];
+        return slot.used ? &slot.value : nullptr;
+    }
+    /// Return a pointer to the value for an id, or nullptr if it has none
+    V* find(size_t id) { return const_cast<V*>(static_cast<const IdTable<V>&>(*this).find(id)); }
+
+    /**
+     * Return the value for an id, default-initializing it if it has none.
+     *
+     * @param id The id to find or insert.
+     * @param inserted Set to whether the id was inserted, if not null.
+     */
+    V& get_or_insert(size_t id, bool* inserted = nullptr) {
+        // Keep the load factor at most 1/2
+        if (2 * (_size + 1) > _slots.size()) _rehash(4 * (_size + 1));
+        Slot& slot = _slots[_find_slot(id)];
+        const bool is_new = !slot.used;
+        if (is_new) {
+            slot.id = id;
+            slot.used = true;
+            ++_size;
+        }
+        if (inserted != nullptr) *inserted = is_new;
+        return slot.value;
+    }
+
+    /// Reserve space for n values
+    void reserve(size_t n) {
+        if (2 * n > _slots.size()) _rehash(2 * n);
+    }
+
+    /// Return the number of ids with values
+    size_t size() const { return _size; }
+};
+
+}  // namespace detail
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_ID_TABLE_H
@@ -0,0 +1,157 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_INSTRUMENT_H
+#define LSST_MODELFIT_PARAMETERS_INSTRUMENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Hot-path counters are compiled out unless this macro is defined before
+ * including any parameters header, e.g. with
+ * -DLSST_MODELFIT_PARAMETERS_INSTRUMENT. All translation units in a program
+ * should be compiled with the same setting.
+ */
+#ifdef LSST_MODELFIT_PARAMETERS_INSTRUMENT
+#define LSST_MODELFIT_PARAMETERS_COUNT_N(counters, counter, n) \
+    ((counters).counter.fetch_add(n, std::memory_order_relaxed))
+#else
+#define LSST_MODELFIT_PARAMETERS_COUNT_N(counters, counter, n) ((void)0)
+#endif
+#define LSST_MODELFIT_PARAMETERS_COUNT(counters, counter) \
+    LSST_MODELFIT_PARAMETERS_COUNT_N(counters, counter, 1)
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * Counts of hot-path events for one type of parameter.
+ *
+ * Counts are atomic (with relaxed ordering) and may be incremented from any
+ * thread.
+ */
+struct Counters {
+    /// Calls to set_value or set_value_transformed
+    std::atomic<uint64_t> set_value{0};
+    /// Values rejected for being beyond limits
+    std::atomic<uint64_t> limit_rejections{0};
+    /// Values clipped to limits
+    std::atomic<uint64_t> clips{0};
+    /// Evaluations of Transform::forward
+    std::atomic<uint64_t> forward{0};
+    /// Evaluations of Transform::reverse
+    std::atomic<uint64_t> reverse{0};
+    /// Evaluations of Transform::derivative (or its variants)
+    std::atomic<uint64_t> derivative{0};
+    /// Exceptions thrown
+    std::atomic<uint64_t> throws{0};
+
+    /// Reset all counts to zero
+    void reset() {
+        for (auto* counter :
+             {&set_value, &limit_rejections, &clips, &forward, &reverse, &derivative, &throws}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// Return a JSON object string of the counts
+    std::string str() const {
+        return std::string("{\"set_value\": ") + std::to_string(set_value.load())
+               + ", \"limit_rejections\": " + std::to_string(limit_rejections.load())
+               + ", \"clips\": " + std::to_string(clips.load()) + ", \"forward\": "
+               + std::to_string(forward.load()) + ", \"reverse\": " + std::to_string(reverse.load())
+               + ", \"derivative\": " + std::to_string(derivative.load())
+               + ", \"throws\": " + std::to_string(throws.load()) + "}";
+    }
+};
+
+/**
+ * A global registry of Counters, keyed by parameter name (get_name()).
+ *
+ * Counters are created on first use and never destroyed, so references to
+ * them remain valid for the lifetime of the program.
+ */
+class Instrumentation {
+private:
+    static std::mutex& _get_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static std::map<std::string, Counters, std::less<>>& _get_registry() {
+        static std::map<std::string, Counters, std::less<>> registry;
+        return registry;
+    }
+
+public:
+    /// Return whether counters are compiled in
+    static constexpr bool enabled() {
+#ifdef LSST_MODELFIT_PARAMETERS_INSTRUMENT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// Get the Counters for a parameter name, creating them if necessary
+    static Counters& get_counters(const std::string& name) {
+        std::lock_guard<std::mutex> lock(_get_mutex());
+        auto& registry = _get_registry();
+        auto found = registry.find(name);
+        if (found == registry.end()) found = registry.try_emplace(name).first;
+        return found->second;
+    }
+
+    /// Get the names of all parameters with Counters
+    static std::vector<std::string> get_names() {
+        std::lock_guard<std::mutex> lock(_get_mutex());
+        std::vector<std::string> names;
+        for (const auto& [name, counters] : _get_registry()) names.push_back(name);
+        return names;
+    }
+
+    /// Return a JSON object string of all Counters, keyed by parameter name
+    static std::string report() {
+        std::lock_guard<std::mutex> lock(_get_mutex());
+        std::string result = "{";
+        bool first = true;
+        for (const auto& [name, counters] : _get_registry()) {
+            result += (first ? "\"" : ", \"") + name + "\": " + counters.str();
+            first = false;
+        }
+        return result + "}";
+    }
+
+    /// Reset all Counters to zero
+    static void reset() {
+        std::lock_guard<std::mutex> lock(_get_mutex());
+        for (auto& [name, counters] : _get_registry()) counters.reset();
+    }
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_INSTRUMENT_H
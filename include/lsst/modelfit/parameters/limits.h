@@ -25,10 +25,16 @@
 #ifndef LSST_MODELFIT_PARAMETERS_LIMITS_H
 #define LSST_MODELFIT_PARAMETERS_LIMITS_H
 
+#include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <cstddef>
 #include <limits>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 
 #include "object.h"
 #include "transform.h"
@@ -36,9 +42,62 @@
 
 namespace lsst::modelfit::parameters {
 
+/// How to handle values beyond Limits when setting them
+enum class LimitPolicy {
+    /// Throw an exception
+    error,
+    /// Set the closest value within the limits instead
+    clip,
+    /// Reflect the value back within the limits off of the violated bound
+    reflect,
+    /// Clip the value and return its squared distance to the limits as a penalty
+    penalize,
+};
+
+/// Return the name of a LimitPolicy
+inline std::string_view to_string(LimitPolicy policy) {
+    switch (policy) {
+        case LimitPolicy::error:
+            return "error";
+        case LimitPolicy::clip:
+            return "clip";
+        case LimitPolicy::reflect:
+            return "reflect";
+        case LimitPolicy::penalize:
+            return "penalize";
+    }
+    throw std::invalid_argument("Unknown LimitPolicy=" + std::to_string(static_cast<int>(policy)));
+}
+
+/**
+ * Call a function templated on a LimitPolicy with a runtime policy.
+ *
+ * @param policy The policy to pass.
+ * @param func A (generic) callable taking a
+ *      std::integral_constant<LimitPolicy, policy> argument.
+ * @return The result of func.
+ */
+template <typename F>
+decltype(auto) visit_limit_policy(LimitPolicy policy, F&& func) {
+    switch (policy) {
+        case LimitPolicy::clip:
+            return func(std::integral_constant<LimitPolicy, LimitPolicy::clip>{});
+        case LimitPolicy::reflect:
+            return func(std::integral_constant<LimitPolicy, LimitPolicy::reflect>{});
+        case LimitPolicy::penalize:
+            return func(std::integral_constant<LimitPolicy, LimitPolicy::penalize>{});
+        case LimitPolicy::error:
+        default:
+            return func(std::integral_constant<LimitPolicy, LimitPolicy::error>{});
+    }
+}
+
 /**
  * Range-based limits for parameter values.
  *
+ * Periodic limits (e.g. for angles) have a finite period of max - min and
+ * values should be wrapped into [min, max) rather than rejected or clipped.
+ *
  * @tparam T The type of the value. Only floating point values are tested.
  */
 template <typename T>
@@ -46,20 +105,37 @@ class Limits : public Object {
 private:
     T _min;
     T _max;
+    bool _periodic;
 
     constexpr void _check(const T& min, const T& max) const {
         if (std::isnan(min) || std::isnan(max))
             throw std::runtime_error(str() + " can't be initialized with NaN limits");
         if (!(min <= max)) throw std::invalid_argument(str() + " can't be initialized with !(min <= max)");
+        _check_periodic(min, max);
     }
 
     inline void _check_min(const T& min) const {
         if (std::isnan(min)) throw std::invalid_argument(str() + " set_min given NaN");
         if (!(min <= _max)) throw std::invalid_argument(str() + " set_min !(min_new <= max)");
+        _check_periodic(min, _max);
     }
     inline void _check_max(const T& max) const {
         if (std::isnan(max)) throw std::invalid_argument(str() + " set_max given NaN");
         if (!(max >= _min)) throw std::invalid_argument(str() + " set_max !(min <= max_new)");
+        _check_periodic(_min, max);
+    }
+    inline void _check_periodic(const T& min, const T& max) const {
+        if (_periodic && !(std::isfinite(min) && std::isfinite(max) && (min < max))) {
+            throw std::invalid_argument(str() + " periodic limits must be finite with min < max");
+        }
+    }
+
+    /// Wrap a value into [min, max), without branching so that loops can vectorize
+    inline T _wrap(T value) const {
+        const T period = _max - _min;
+        const T wrapped = value - period * std::floor((value - _min) / period);
+        // Rounding may leave the result one ulp outside [min, max)
+        return ((wrapped >= _max) || (wrapped < _min)) ? _min : wrapped;
     }
 
 public:
@@ -67,11 +143,67 @@ public:
     inline bool check(T value) const { return value >= _min && value <= _max; }
     /// Return the closest value to the input that is within the limits
     inline T clip(T value) const { return value > _max ? _max : (value < _min ? _min : value); }
+    /**
+     * Return the value reflected back within the limits.
+     *
+     * Values beyond one bound are mirrored about it; if both bounds are
+     * finite, values are reflected repeatedly (as a triangle wave).
+     */
+    T reflect(T value) const {
+        if (check(value)) return value;
+        const T width = _max - _min;
+        if (std::isfinite(width)) {
+            if (!(width > 0)) return _min;
+            T offset = std::fmod(value - _min, 2 * width);
+            if (offset < 0) offset += 2 * width;
+            return clip(offset > width ? _max - (offset - width) : _min + offset);
+        }
+        return value < _min ? 2 * _min - value : 2 * _max - value;
+    }
+    /**
+     * Apply a LimitPolicy (other than error) to a value beyond the limits.
+     *
+     * @param value The value to modify in-place. NaN values are unchanged.
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy>
+    T enforce(T& value) const {
+        static_assert(policy != LimitPolicy::error, "LimitPolicy::error can't be enforced on values");
+        if constexpr (policy == LimitPolicy::reflect) {
+            value = reflect(value);
+            return 0;
+        } else {
+            const T clipped = clip(value);
+            T penalty = 0;
+            if constexpr (policy == LimitPolicy::penalize) penalty = (value - clipped) * (value - clipped);
+            value = clipped;
+            return penalty;
+        }
+    }
+    /**
+     * Return the equivalent value within [min, max) if periodic, or else
+     * the value unchanged.
+     *
+     * Non-finite values are returned as NaN if periodic.
+     */
+    inline T wrap(T value) const { return _periodic ? _wrap(value) : value; }
+    /// Write the wrapped value of each of the n values in x to out, which may alias x
+    void wrap_batch(const T* x, T* out, size_t n) const {
+        if (_periodic) {
+            for (size_t i = 0; i < n; ++i) out[i] = _wrap(x[i]);
+        } else if (out != x) {
+            std::copy(x, x + n, out);
+        }
+    }
 
     /// Return the minimum
     inline T get_min() const { return _min; };
     /// Return the maximum
     inline T get_max() const { return _max; };
+    /// Return the period (max - min) if periodic, or else zero
+    inline T get_period() const { return _periodic ? _max - _min : 0; }
+    /// Return whether values should be wrapped into [min, max)
+    inline bool get_periodic() const { return _periodic; }
 
     std::string name;
 
@@ -96,22 +228,57 @@ public:
                      const std::string_view& namespace_separator = CC_NAMESPACE_SEPARATOR) const override {
         return type_name_str<Limits<T>>(false, namespace_separator) + "(" + (name_keywords ? "min=" : "")
                + std::to_string(_min) + ", " + (name_keywords ? "max=" : "") + std::to_string(_max) + ", "
-               + (name_keywords ? "name='" : "") + name + "')";
+               + (name_keywords ? "name='" : "") + name + "'"
+               + (_periodic ? std::string(", ") + (name_keywords ? "periodic=" : "") + "1" : "") + ")";
     }
     std::string str() const override {
         return type_name_str<Limits<T>>(true) + "(" + std::to_string(_min) + ", " + std::to_string(_max)
-               + ", '" + name + "')";
+               + ", '" + name + "'" + (_periodic ? ", periodic=1" : "") + ")";
     }
 
-    /// Initialize limits from the minimum and maximum value.
+    /**
+     * Initialize limits from the minimum and maximum value.
+     *
+     * @param min The minimum value.
+     * @param max The maximum value.
+     * @param name_ A name for the limits.
+     * @param periodic Whether values wrap around with a period of max - min,
+     *      which must then be finite and positive.
+     */
     Limits(T min = -std::numeric_limits<T>::infinity(), T max = std::numeric_limits<T>::infinity(),
-           std::string name_ = "")
-            : _min(min), _max(max), name(name_) {
+           std::string name_ = "", bool periodic = false)
+            : _min(min), _max(max), _periodic(periodic), name(name_) {
         _check(min, max);
     }
 
     ~Limits(){};
 };
 
+/**
+ * Return limits for values transformed by a monotonic Transform.
+ *
+ * The transformed endpoints are swapped for decreasing transforms, and
+ * endpoints that transform to NaN (e.g. the log of -inf) are replaced by
+ * infinities.
+ *
+ * @param limits The limits of the untransformed values.
+ * @param transform The monotonic transform.
+ * @param value A value within limits, at which the sign of the derivative
+ *      determines the direction of the transform if the endpoints can't.
+ * @return The limits of the transformed values.
+ */
+template <typename T>
+Limits<T> transform_limits(const Limits<T>& limits, const Transform<T>& transform, T value) {
+    T lower = transform.forward(limits.get_min());
+    T upper = transform.forward(limits.get_max());
+    const bool decreasing = (std::isnan(lower) || std::isnan(upper) || (lower == upper))
+                                    ? (transform.derivative(value) < 0)
+                                    : (lower > upper);
+    if (decreasing) std::swap(lower, upper);
+    if (std::isnan(lower)) lower = -std::numeric_limits<T>::infinity();
+    if (std::isnan(upper)) upper = std::numeric_limits<T>::infinity();
+    return Limits<T>(lower, upper, limits.name.empty() ? "" : (limits.name + ".transformed"));
+}
+
 }  // namespace lsst::modelfit::parameters
 #endif  // LSST_MODELFIT_PARAMETERS_LIMITS_H
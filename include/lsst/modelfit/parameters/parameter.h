@@ -25,22 +25,35 @@
 #ifndef LSST_MODELFIT_PARAMETERS_PARAMETER_H
 #define LSST_MODELFIT_PARAMETERS_PARAMETER_H
 
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 
+#include "instrument.h"
 #include "limits.h"
 #include "object.h"
+#include "statistics.h"
 #include "transform.h"
 #include "type_name.h"
 #include "unit.h"
 
 namespace lsst::modelfit::parameters {
 
+namespace detail {
+/// A counter incremented whenever any parameter's free status or transform changes
+inline std::atomic<uint64_t> structure_epoch{0};
+/// The id of the next parameter to be created
+inline std::atomic<size_t> parameter_id_next{0};
+}  // namespace detail
+
 /**
  * @brief Interface for parameters with values and metadata.
  *
@@ -56,21 +69,34 @@ namespace lsst::modelfit::parameters {
  */
 template <typename T>
 class ParameterBase : public Object {
+private:
+    const size_t _id;
+
+protected:
+    ParameterBase() : _id(detail::parameter_id_next++) {}
+    /// Copies are new parameters and so have a new id
+    ParameterBase(const ParameterBase<T>&) : ParameterBase() {}
+    ParameterBase<T>& operator=(const ParameterBase<T>&) { return *this; }
+
 public:
+    /// Return the instrumentation Counters for this parameter's type, which are looked up only once.
+    virtual Counters& get_counters() const = 0;
     /// Get the default value.
     virtual T get_default() const = 0;
     /// Get a string description for this parameter class.
-    virtual std::string get_desc() const = 0;
+    virtual const std::string& get_desc() const = 0;
     /// Return whether the parameter is fixed (not free).
     virtual bool get_fixed() const = 0;
     /// Return whether the parameter is free (not fixed).
     virtual bool get_free() const = 0;
     /// Return a string label for this parameter instance.
-    virtual std::string get_label() const = 0;
+    virtual const std::string& get_label() const = 0;
     /// Return the limits for the untransformed value.
     virtual const Limits<T>& get_limits() const = 0;
     /// Return limits representing the maximum/minimum untransformed value.
     virtual const Limits<T>& get_limits_maximal() const = 0;
+    /// Return the limits for the transformed value, cached when limits or the transform are set.
+    virtual const Limits<T>& get_limits_transformed() const = 0;
     /// Return whether the parameter is linear.
     virtual bool get_linear() const = 0;
     /// Return the minimum value for this parameter instance.
@@ -78,38 +104,114 @@ public:
     /// Return the maximum value for this parameter instance.
     virtual T get_max() const = 0;
     /// Get a string name for this parameter class.
-    virtual std::string get_name() const = 0;
+    virtual const std::string& get_name() const = 0;
     /// Return the transforming function for this parameter instance.
     virtual const Transform<T>& get_transform() const = 0;
     /// Return the derivative of the transform for this parameter instance.
     virtual T get_transform_derivative() const = 0;
     /// Return the transform pointer for this parameter instance.
     virtual std::shared_ptr<const Transform<T>> get_transform_ptr() const = 0;
+    /**
+     * Return the id of this parameter instance.
+     *
+     * Ids are unique and assigned consecutively from zero in order of
+     * creation (across all value types), and so are reproducible between
+     * runs that create parameters in the same order. They are dense enough
+     * to index vectors (see ParameterTable).
+     */
+    size_t get_id() const { return _id; }
     /// Return the untransformed value of this parameter instance.
     virtual T get_value() const = 0;
     /// Return the transformed value of this parameter instance.
     virtual T get_value_transformed() const = 0;
+    /// Return whether set_value_transformed stores the given transformed value.
+    virtual bool get_transformed_exact() const = 0;
+    /// Return whether the transformed value is computed lazily, on first read.
+    virtual bool get_transformed_lazy() const = 0;
     /// Return the unit of this parameter instance.
     virtual const Unit& get_unit() const = 0;
+    /// Return a counter that is incremented whenever the value is set.
+    virtual uint64_t get_version() const = 0;
+    /// Return a counter that is incremented whenever the free status or transform changes after init.
+    virtual uint64_t get_version_structure() const = 0;
     /// Set the parameter to be fixed (or not).
     virtual void set_fixed(bool fixed) = 0;
     /// Set the parameter to be free (or not).
     virtual void set_free(bool free) = 0;
     /// Set the string label for this parameter instance.
     virtual void set_label(std::string label) = 0;
+    /**
+     * Set whether set_value_transformed stores the given transformed value,
+     * rather than transforming the reversed value again.
+     *
+     * The stored transformed value then differs from the transform of the
+     * value by the transform's round trip error (see
+     * Transform::round_trip_error), which should be checked to be
+     * acceptable before enabling this. Values changed by a limit policy or
+     * by periodic wrapping are always transformed again.
+     */
+    virtual void set_transformed_exact(bool exact) = 0;
+    /**
+     * Set whether setting the untransformed value defers computing the
+     * transformed value until it is first read by get_value_transformed.
+     *
+     * This avoids transforming values that are never read in transformed
+     * space, e.g. while initializing models. Lazy reads modify cached state
+     * and so are not safe to call concurrently.
+     */
+    virtual void set_transformed_lazy(bool lazy) = 0;
     /// Set the limits for this parameter instance.
     virtual void set_limits(std::shared_ptr<const Limits<T>> limits) = 0;
     /// Set the transforming function for this parameter instance.
     virtual void set_transform(std::shared_ptr<const Transform<T>> transform) = 0;
     /// Set the untransformed value for this parameter instance.
     virtual void set_value(T value) = 0;
+    /**
+     * Set the untransformed value, handling values beyond limits with a policy.
+     *
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    virtual T set_value(T value, LimitPolicy policy) = 0;
     /// Set the transformed value for this parameter instance.
     virtual void set_value_transformed(T value_transformed) = 0;
+    /**
+     * Set the transformed value, handling (untransformed) values beyond limits
+     * with a policy.
+     *
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    virtual T set_value_transformed(T value_transformed, LimitPolicy policy) = 0;
+    /**
+     * Set the untransformed value along with its already-computed transformed
+     * value.
+     *
+     * If set_transformed_exact is enabled, the transformed value is stored
+     * as-is unless the value is changed by wrapping or the policy. Otherwise,
+     * it is ignored and the value is transformed again, as by set_value.
+     *
+     * @param value The untransformed value.
+     * @param value_transformed The transformed value, which must equal
+     *      get_transform().forward(value) to within rounding.
+     * @param policy The policy for values beyond limits.
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    virtual T set_value_with_transformed(T value, T value_transformed, LimitPolicy policy) = 0;
     /// Set the unit for this parameter instance.
     virtual void set_unit(std::shared_ptr<const Unit> unit = nullptr) = 0;
 
     static const UnitTransform<T>& transform_none() { return UnitTransform<T>::get(); };
 
+    /**
+     * Return a counter that is incremented whenever any parameter's free
+     * status or transform is changed after its initialization.
+     *
+     * Views that depend only on which parameters are free and how they are
+     * transformed can compare this to quickly check whether they may be
+     * invalid, and then check get_version_structure() of their own
+     * parameters (see ParameterCollection::get_structure_version).
+     */
+    static uint64_t get_structure_epoch() { return detail::structure_epoch.load(std::memory_order_relaxed); }
+
     friend bool operator==(const ParameterBase<T>& first, const ParameterBase<T>& second) {
         return &first == &second;
     }
@@ -118,13 +220,47 @@ public:
         return &first != &second;
     }
 
+    /// Order parameters by id, i.e. by order of creation
     friend bool operator<(const ParameterBase<T>& first, const ParameterBase<T>& second) {
-        return std::less<const ParameterBase<T>*>{}(&first, &second) == true;
+        return first._id < second._id;
     }
 
     virtual ~ParameterBase() = default;
 };
 
+namespace detail {
+/// Return the id of a parameter or a (smart) pointer to one
+template <typename P>
+size_t get_parameter_id(const P& parameter) {
+    if constexpr (std::is_base_of_v<Object, P>) {
+        return parameter.get_id();
+    } else {
+        return parameter->get_id();
+    }
+}
+}  // namespace detail
+
+/**
+ * Orders parameters, or (smart) pointers to them, by id.
+ *
+ * This is a deterministic comparator for ordered containers, unlike the
+ * default for pointers, which orders by address.
+ */
+struct ParameterIdLess {
+    template <typename P>
+    bool operator()(const P& first, const P& second) const {
+        return detail::get_parameter_id(first) < detail::get_parameter_id(second);
+    }
+};
+
+/// Hashes parameters, or (smart) pointers to them, by id
+struct ParameterIdHash {
+    template <typename P>
+    size_t operator()(const P& parameter) const {
+        return std::hash<size_t>{}(detail::get_parameter_id(parameter));
+    }
+};
+
 /**
  * @brief A parameter with values and metadata.
  *
@@ -172,6 +308,8 @@ private:
     static constexpr T _max = std::numeric_limits<T>::infinity();
     /// Whether this Parameter is a linear parameter in a model
     static constexpr bool _linear = false;
+    /// Whether values of this Parameter wrap around from _max to _min
+    static constexpr bool _periodic = false;
     /// Whether this Parameter is a free parameter in a model
     bool _free = true;
     /// A Limiter to further restrict this parameter's values
@@ -184,34 +322,104 @@ private:
     std::shared_ptr<const Limits<T>> _limits_ptr;
     /// The Transform for this parameter, if not default
     std::shared_ptr<const Transform<T>> _transform_ptr;
+    /// The limits for the transformed value
+    Limits<T> _limits_transformed;
     /// The Unit for this parameter's untransformed value
     std::shared_ptr<const Unit> _unit_ptr;
+    /// The number of times the value has been set
+    uint64_t _version = 0;
+    /// The number of times the free status or transform has changed
+    uint64_t _version_structure = 0;
+    /// Whether set_value_transformed stores the given transformed value
+    bool _transformed_exact = false;
+    /// Whether setting the value defers computing the transformed value
+    bool _transformed_lazy = false;
+    /// Whether the transformed value needs to be recomputed
+    mutable bool _transformed_stale = false;
+#ifdef LSST_MODELFIT_PARAMETERS_STATISTICS
+    /// The cached location of this parameter's value statistics
+    ValueStatisticsSlot<T> _stats_slot;
+#endif
+
+    /// Compute the transformed value now, or on the next read if lazy
+    void _update_transformed() {
+        if (_transformed_lazy) {
+            _transformed_stale = true;
+        } else {
+            _compute_transformed();
+        }
+    }
+
+    /// Compute the transformed value and mark it as current
+    void _compute_transformed() const {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), forward);
+        _value_transformed = _transformer->transform.forward(_value);
+        _transformed_stale = false;
+    }
 
-    /// Set the untransformed value, checking limits
-    void _set_value(T value) {
-        if (!(get_limits().check(value)))
-            throw std::runtime_error(this->str() + "Value=" + std::to_string(value)
-                                     + " beyond get_limits()=" + get_limits().str());
+    /// Recompute the limits for the transformed value
+    void _update_limits_transformed() {
+        _limits_transformed = transform_limits(get_limits(), get_transform(), _value);
+    }
+
+    /// Throw an exception for a value beyond limits (kept out of line from setters)
+    [[noreturn]] void _throw_beyond_limits(T value) const {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), limit_rejections);
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), throws);
+        throw std::runtime_error(this->str() + "Value=" + std::to_string(value)
+                                 + " beyond get_limits()=" + get_limits().str());
+    }
+
+    /**
+     * Set the untransformed value, wrapping periodic values and applying
+     * a policy to values beyond limits.
+     *
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy>
+    T _set_value(T value) {
+        const auto& limits = get_limits();
+        value = limits.wrap(value);
+        T penalty = 0;
+        if (!(limits.check(value))) {
+            if constexpr (policy != LimitPolicy::error) {
+                LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), clips);
+                penalty = limits.template enforce<policy>(value);
+            }
+            // NaN values can't be enforced
+            if (!(limits.check(value))) _throw_beyond_limits(value);
+        }
         _value = value;
+        ++_version;
+        LSST_MODELFIT_PARAMETERS_RECORD(_stats_slot, _get_name(), _label, _value);
+        return penalty;
     }
 
 protected:
     /// The untransformed value
     T _value;
-    /// The cached, transformed value
-    T _value_transformed;
+    /// The cached, transformed value (which is stale if _transformed_stale)
+    mutable T _value_transformed;
 
-    static const std::string _get_desc() { return C::_desc; }
+    /// Get the instrumentation Counters for the derived type of this
+    static Counters& _get_counters() {
+        static Counters& counters = Instrumentation::get_counters(_get_name());
+        return counters;
+    }
+    static const std::string& _get_desc() { return C::_desc; }
     static constexpr bool _get_linear() { return C::_linear; }
     static constexpr T _get_min() { return C::_min; }
     static constexpr T _get_max() { return C::_max; }
-    static const std::string _get_name() { return C::_name; }
+    static constexpr bool _get_periodic() { return C::_periodic; }
+    static const std::string& _get_name() { return C::_name; }
 
 public:
     /// Get the default value for the derived type of this
     static constexpr T _get_default() { return C::_default; }
 
-    std::string get_desc() const override { return _get_desc(); }
+    Counters& get_counters() const override { return _get_counters(); }
+
+    const std::string& get_desc() const override { return _get_desc(); }
 
     T get_default() const override { return _get_default(); }
 
@@ -219,29 +427,33 @@ public:
 
     bool get_free() const override { return _free; }
 
-    std::string get_label() const override { return _label; }
+    const std::string& get_label() const override { return _label; }
 
     const Limits<T>& get_limits_maximal() const override {
         static const Limits<T> limits_maximal
-                = Limits<T>(_get_min(), _get_max(), std::string(type_name<C>()) + ".limits_maximal");
+                = Limits<T>(_get_min(), _get_max(), std::string(type_name<C>()) + ".limits_maximal",
+                            _get_periodic());
         return limits_maximal;
     }
 
     const Limits<T>& get_limits() const override { return _limiter->limits; }
 
+    const Limits<T>& get_limits_transformed() const override { return _limits_transformed; }
+
     bool get_linear() const override { return _get_linear(); }
 
     T get_min() const override { return _get_min(); }
 
     T get_max() const override { return _get_max(); }
 
-    std::string get_name() const override { return _get_name(); }
+    const std::string& get_name() const override { return _get_name(); }
 
     const Transform<T>& get_transform() const override { return _transformer->transform; }
 
     std::shared_ptr<const Transform<T>> get_transform_ptr() const override { return _transform_ptr; }
 
     T get_transform_derivative() const override {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), derivative);
         return this->get_transform().derivative(this->get_value());
     }
     /// Get the name of the derived type of this
@@ -255,14 +467,40 @@ public:
 
     T get_value() const override { return _value; }
 
-    T get_value_transformed() const override { return _value_transformed; }
+    uint64_t get_version() const override { return _version; }
+    uint64_t get_version_structure() const override { return _version_structure; }
+
+    T get_value_transformed() const override {
+        if (_transformed_stale) _compute_transformed();
+        return _value_transformed;
+    }
+
+    bool get_transformed_exact() const override { return _transformed_exact; }
+
+    bool get_transformed_lazy() const override { return _transformed_lazy; }
 
     /// Return a shared pointer to this
     std::shared_ptr<C> ptr() { return this->shared_from_this(); }
 
     void set_fixed(bool fixed) override { set_free(!fixed); }
-    void set_free(bool free) override { _free = free; }
-    void set_label(std::string label) override { _label = std::move(label); }
+    void set_free(bool free) override {
+        if (free != _free) {
+            _free = free;
+            ++_version_structure;
+            ++detail::structure_epoch;
+        }
+    }
+    void set_transformed_exact(bool exact) override { _transformed_exact = exact; }
+    void set_transformed_lazy(bool lazy) override {
+        _transformed_lazy = lazy;
+        if (!lazy && _transformed_stale) _compute_transformed();
+    }
+    void set_label(std::string label) override {
+        _label = std::move(label);
+#ifdef LSST_MODELFIT_PARAMETERS_STATISTICS
+        _stats_slot.clear();
+#endif
+    }
     void set_limits(std::shared_ptr<const Limits<T>> limits) override {
         // TODO: Fix bad_alloc when calling this without &
         // Disable copy constructor explicitly maybe?
@@ -271,6 +509,7 @@ public:
             _limiter = std::make_unique<Limiter>(limits_maximal);
         } else {
             if (!((limits->get_min() >= this->get_min()) && (limits->get_max() <= this->get_max()))) {
+                LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), throws);
                 std::string error = get_type_name() + ".set_limits(" + limits->str()
                                     + ") sets limits that are less restrictive than the minimum="
                                     + limits_maximal.str();
@@ -279,8 +518,11 @@ public:
             _limits_ptr = std::move(limits);
             _limiter = std::make_unique<Limiter>(*_limits_ptr);
         }
+        // The constructor sets limits before the transform
+        if (_transformer != nullptr) _update_limits_transformed();
     }
     void set_transform(const std::shared_ptr<const Transform<T>> transform) override {
+        const bool was_initialized = _transformer != nullptr;
         if (transform == nullptr) {
             // TODO: determine why passing transform_none as arg here returns:
             // error: modification of '<temporary>' is not a constant expression
@@ -291,18 +533,87 @@ public:
             _transform_ptr = std::move(transform);
             _transformer = std::make_unique<Transformer>(*_transform_ptr);
         }
-        _value_transformed = _transformer->transform.forward(_value);
+        // The constructor sets the first transform, which changes nothing
+        if (was_initialized) {
+            ++_version_structure;
+            ++detail::structure_epoch;
+        }
+        _update_transformed();
+        _update_limits_transformed();
     }
 
-    void set_value(T value) override {
-        _set_value(value);
-        double value_new = this->get_value();
-        _value_transformed = _transformer->transform.forward(value_new);
-    };
+    void set_value(T value) override { set_value<LimitPolicy::error>(value); };
+
+    T set_value(T value, LimitPolicy policy) override {
+        return visit_limit_policy(policy, [this, value](auto policy_c) {
+            return this->template set_value<decltype(policy_c)::value>(value);
+        });
+    }
+
+    /**
+     * Set the untransformed value, handling values beyond limits with a
+     * policy selected at compile time.
+     *
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy>
+    T set_value(T value) {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), set_value);
+        const T penalty = _set_value<policy>(value);
+        _update_transformed();
+        return penalty;
+    }
 
     void set_value_transformed(T value_transformed) override {
-        _set_value(_transformer->transform.reverse(value_transformed));
-        _value_transformed = _transformer->transform.forward(this->get_value());
+        set_value_transformed<LimitPolicy::error>(value_transformed);
+    }
+
+    T set_value_transformed(T value_transformed, LimitPolicy policy) override {
+        return visit_limit_policy(policy, [this, value_transformed](auto policy_c) {
+            return this->template set_value_transformed<decltype(policy_c)::value>(value_transformed);
+        });
+    }
+
+    T set_value_with_transformed(T value, T value_transformed, LimitPolicy policy) override {
+        return visit_limit_policy(policy, [this, value, value_transformed](auto policy_c) {
+            return this->template set_value_with_transformed<decltype(policy_c)::value>(value,
+                                                                                         value_transformed);
+        });
+    }
+
+    /// Set the untransformed and transformed value with a policy selected at compile time
+    template <LimitPolicy policy>
+    T set_value_with_transformed(T value, T value_transformed) {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), set_value);
+        const T penalty = _set_value<policy>(value);
+        if (_transformed_exact && (_value == value)) {
+            _value_transformed = value_transformed;
+            _transformed_stale = false;
+        } else {
+            _update_transformed();
+        }
+        return penalty;
+    }
+
+    /**
+     * Set the transformed value, handling (untransformed) values beyond
+     * limits with a policy selected at compile time.
+     *
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy>
+    T set_value_transformed(T value_transformed) {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), set_value);
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), reverse);
+        const T value = _transformer->transform.reverse(value_transformed);
+        const T penalty = _set_value<policy>(value);
+        if (_transformed_exact && (_value == value)) {
+            _value_transformed = value_transformed;
+            _transformed_stale = false;
+        } else {
+            _update_transformed();
+        }
+        return penalty;
     }
 
     void set_unit(std::shared_ptr<const Unit> unit = nullptr) override {
@@ -348,7 +659,7 @@ public:
         _value = value;
         set_transform(transform == nullptr ? nullptr : std::move(transform));
         set_unit(unit);
-        set_fixed(fixed);
+        _free = !fixed;
         set_label(label);
     }
     ~Parameter(){};
@@ -0,0 +1,646 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_PARAMETER_ARRAY_H
+#define LSST_MODELFIT_PARAMETERS_PARAMETER_ARRAY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "instrument.h"
+#include "limits.h"
+#include "object.h"
+#include "parameter.h"
+#include "statistics.h"
+#include "transform.h"
+#include "type_name.h"
+#include "unit.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief An array of parameter values sharing a single set of metadata.
+ *
+ * All elements share the same limits, transform, unit and label prefix;
+ * only their values, transformed values and free/fixed status are stored
+ * per element, contiguously. Individual elements can be accessed as
+ * ParameterBase instances with get_element, e.g. to add to a
+ * ParameterCollection.
+ *
+ * Like Parameter, derived classes need only define static members, e.g.
+ * _desc and _name, and optionally _default, _min, _max and _linear.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ * @tparam C The derived class.
+ *
+ * @note Elements are views into the array and share ownership of it, so the
+ * array must be owned by a shared_ptr to call get_element.
+ */
+template <typename T, class C>
+class ParameterArray : public Object, public std::enable_shared_from_this<C> {
+public:
+    /// A view of a single element of a ParameterArray
+    class Element : public ParameterBase<T> {
+    private:
+        ParameterArray<T, C>& _array;
+        size_t _index;
+        std::string _label;
+
+        [[noreturn]] void _throw_shared(const std::string& name) const {
+            throw std::logic_error(this->str() + "." + name + " can't be called on an element; call "
+                                   + type_name_str<C>(true) + "." + name + " instead");
+        }
+
+    public:
+        Counters& get_counters() const override { return _array._get_counters(); }
+        const std::string& get_desc() const override { return _array._get_desc(); }
+        T get_default() const override { return _array._get_default(); }
+        bool get_fixed() const override { return !_array._free[_index]; }
+        bool get_free() const override { return _array._free[_index]; }
+        /// Return the index of this element in its array
+        size_t get_index() const { return _index; }
+        const std::string& get_label() const override { return _label; }
+        const Limits<T>& get_limits() const override { return _array.get_limits(); }
+        const Limits<T>& get_limits_maximal() const override { return _array.get_limits_maximal(); }
+        const Limits<T>& get_limits_transformed() const override { return _array.get_limits_transformed(); }
+        bool get_linear() const override { return _array._get_linear(); }
+        T get_min() const override { return _array._get_min(); }
+        T get_max() const override { return _array._get_max(); }
+        const std::string& get_name() const override { return _array._get_name(); }
+        const Transform<T>& get_transform() const override { return _array.get_transform(); }
+        T get_transform_derivative() const override {
+            LSST_MODELFIT_PARAMETERS_COUNT(_array._get_counters(), derivative);
+            return _array.get_transform().derivative(_array._values[_index]);
+        }
+        std::shared_ptr<const Transform<T>> get_transform_ptr() const override {
+            return _array.get_transform_ptr();
+        }
+        T get_value() const override { return _array._values[_index]; }
+        T get_value_transformed() const override { return _array.get_values_transformed()[_index]; }
+        const Unit& get_unit() const override { return _array.get_unit(); }
+        /// Return the version of the whole array, which is incremented when any element is set
+        uint64_t get_version() const override { return _array._version; }
+        /// Return the structure version of the whole array, which is incremented when any element changes
+        uint64_t get_version_structure() const override { return _array._version_structure; }
+        bool get_transformed_exact() const override { return _array._transformed_exact; }
+        bool get_transformed_lazy() const override { return _array._transformed_lazy; }
+
+        void set_fixed(bool fixed) override { _array.set_free(_index, !fixed); }
+        void set_free(bool free) override { _array.set_free(_index, free); }
+        /// Not supported; the mode is shared by all elements
+        void set_transformed_exact(bool) override { _throw_shared("set_transformed_exact"); }
+        /// Set whether transformed values are computed lazily for the whole array
+        void set_transformed_lazy(bool lazy) override { _array.set_transformed_lazy(lazy); }
+        void set_label(std::string label) override { _label = std::move(label); }
+        /// Not supported; limits are shared by all elements
+        void set_limits(std::shared_ptr<const Limits<T>>) override { _throw_shared("set_limits"); }
+        /// Not supported; the transform is shared by all elements
+        void set_transform(std::shared_ptr<const Transform<T>>) override { _throw_shared("set_transform"); }
+        void set_value(T value) override { _array.set_value(_index, value); }
+        T set_value(T value, LimitPolicy policy) override { return _array.set_value(_index, value, policy); }
+        void set_value_transformed(T value_transformed) override {
+            _array.set_value_transformed(_index, value_transformed);
+        }
+        T set_value_transformed(T value_transformed, LimitPolicy policy) override {
+            return _array.set_value_transformed(_index, value_transformed, policy);
+        }
+        T set_value_with_transformed(T value, T value_transformed, LimitPolicy policy) override {
+            return _array.set_value_with_transformed(_index, value, value_transformed, policy);
+        }
+        /// Not supported; the unit is shared by all elements
+        void set_unit(std::shared_ptr<const Unit> = nullptr) override { _throw_shared("set_unit"); }
+
+        std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                     = Object::CC_NAMESPACE_SEPARATOR) const override {
+            return type_name_str<C>(false, namespace_separator) + std::string(namespace_separator)
+                   + "Element(" + (name_keywords ? "index=" : "") + std::to_string(_index) + ", "
+                   + (name_keywords ? "value=" : "") + std::to_string(get_value()) + ", "
+                   + (name_keywords ? "label='" : "'") + _label + "')";
+        }
+        std::string str() const override {
+            return type_name_str<C>(true) + "[" + std::to_string(_index)
+                   + "](value=" + std::to_string(get_value()) + ", label='" + _label + "')";
+        }
+
+        Element(ParameterArray<T, C>& array, size_t index)
+                : _array(array), _index(index), _label(array._label + "[" + std::to_string(index) + "]") {}
+    };
+
+private:
+    /// The default value for this type of ParameterArray
+    static constexpr T _default = 0;
+    /// The minimum valid value (inclusive) for this type of ParameterArray
+    static constexpr T _min = -std::numeric_limits<T>::infinity();
+    /// The maximum valid value (inclusive) for this type of ParameterArray
+    static constexpr T _max = std::numeric_limits<T>::infinity();
+    /// Whether this ParameterArray is a linear parameter in a model
+    static constexpr bool _linear = false;
+    /// Whether values of this ParameterArray wrap around from _max to _min
+    static constexpr bool _periodic = false;
+
+    /// The untransformed values
+    std::vector<T> _values;
+    /// The cached, transformed values (which are stale if _transformed_stale)
+    mutable std::vector<T> _values_transformed;
+    /// Whether each element is free
+    std::vector<bool> _free;
+    /// The element views, created on first access
+    std::vector<std::unique_ptr<Element>> _elements;
+    /// A buffer for batch setters
+    std::vector<T> _buffer;
+    /// The label prefix for elements
+    std::string _label;
+    /// The Limits for all elements (never null)
+    const Limits<T>* _limits;
+    /// The Limits for all elements, if not default
+    std::shared_ptr<const Limits<T>> _limits_ptr;
+    /// The Transform for all elements (never null)
+    const Transform<T>* _transform;
+    /// The Transform for all elements, if not default
+    std::shared_ptr<const Transform<T>> _transform_ptr;
+    /// The limits for all elements' transformed values
+    Limits<T> _limits_transformed;
+    /// The Unit for all elements' untransformed values
+    std::shared_ptr<const Unit> _unit_ptr;
+    /// The number of times any value has been set
+    uint64_t _version = 0;
+    /// The number of times any element's free status or the transform has changed
+    uint64_t _version_structure = 0;
+    /// Whether setting transformed values stores them rather than transforming the reversed values
+    bool _transformed_exact = false;
+    /// Whether setting values defers computing transformed values
+    bool _transformed_lazy = false;
+    /// Whether any transformed values need to be recomputed
+    mutable bool _transformed_stale = false;
+#ifdef LSST_MODELFIT_PARAMETERS_STATISTICS
+    /// The cached location of all elements' value statistics
+    ValueStatisticsSlot<T> _stats_slot;
+#endif
+
+    static Counters& _get_counters() {
+        static Counters& counters = Instrumentation::get_counters(_get_name());
+        return counters;
+    }
+    static const std::string& _get_desc() { return C::_desc; }
+    static constexpr T _get_default() { return C::_default; }
+    static constexpr bool _get_linear() { return C::_linear; }
+    static constexpr T _get_min() { return C::_min; }
+    static constexpr T _get_max() { return C::_max; }
+    static constexpr bool _get_periodic() { return C::_periodic; }
+    static const std::string& _get_name() { return C::_name; }
+
+    /// Recompute the limits for the transformed values
+    void _update_limits_transformed() {
+        _limits_transformed = transform_limits(get_limits(), get_transform(),
+                                               size() > 0 ? _values[0] : _get_default());
+    }
+
+    /// Compute all transformed values now, or on the next read if lazy
+    void _update_transformed() {
+        if (_transformed_lazy) {
+            _transformed_stale = true;
+        } else {
+            _compute_transformed();
+        }
+    }
+
+    /// Compute all transformed values in one batch and mark them as current
+    void _compute_transformed() const {
+        LSST_MODELFIT_PARAMETERS_COUNT_N(_get_counters(), forward, size());
+        _transform->forward_batch(_values.data(), _values_transformed.data(), size());
+        _transformed_stale = false;
+    }
+
+    /// Set the transform without changing the structure epoch, as when initializing
+    void _set_transform(std::shared_ptr<const Transform<T>> transform) {
+        _transform_ptr = std::move(transform);
+        _transform = _transform_ptr == nullptr ? &UnitTransform<T>::get() : _transform_ptr.get();
+        _update_transformed();
+        _update_limits_transformed();
+    }
+
+    [[noreturn]] void _throw_beyond_limits(size_t index, T value) const {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), limit_rejections);
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), throws);
+        throw std::runtime_error(this->str() + "[" + std::to_string(index) + "] value="
+                                 + std::to_string(value) + " beyond get_limits()=" + get_limits().str());
+    }
+
+    void _check_size(const std::vector<T>& values) const {
+        if (values.size() != size()) {
+            throw std::invalid_argument(this->str() + " given values.size()=" + std::to_string(values.size())
+                                        + " != size()=" + std::to_string(size()));
+        }
+    }
+
+    /**
+     * Wrap a periodic value and apply a policy if it's beyond limits.
+     *
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy>
+    T _apply_limits(size_t index, T& value) const {
+        const auto& limits = get_limits();
+        value = limits.wrap(value);
+        T penalty = 0;
+        if (!limits.check(value)) {
+            if constexpr (policy != LimitPolicy::error) {
+                LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), clips);
+                penalty = limits.template enforce<policy>(value);
+            }
+            if (!limits.check(value)) _throw_beyond_limits(index, value);
+        }
+        return penalty;
+    }
+
+    /**
+     * Wrap periodic values and apply a policy to any beyond limits, then set
+     * them and their transformed values.
+     *
+     * No values are set if any can't be (e.g. with LimitPolicy::error).
+     *
+     * @param values The untransformed values.
+     * @param values_transformed The transformed values to store, if not null
+     *      and no values were changed by wrapping or the limit policy.
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy>
+    T _set_values(const T* values, const T* values_transformed = nullptr) {
+        const size_t n_values = size();
+        const auto& limits = get_limits();
+        if (limits.get_periodic()) {
+            limits.wrap_batch(values, _buffer.data(), n_values);
+            values = _buffer.data();
+            values_transformed = nullptr;
+        }
+        T penalty = 0;
+        for (size_t idx = 0; idx < n_values; ++idx) {
+            if (!limits.check(values[idx])) {
+                if constexpr (policy != LimitPolicy::error) {
+                    // Modify a copy, since values may be the caller's
+                    if (values != _buffer.data()) {
+                        std::copy(values, values + n_values, _buffer.begin());
+                        values = _buffer.data();
+                    }
+                    LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), clips);
+                    penalty += limits.template enforce<policy>(_buffer[idx]);
+                    values_transformed = nullptr;
+                }
+                if (!limits.check(values[idx])) _throw_beyond_limits(idx, values[idx]);
+            }
+        }
+        LSST_MODELFIT_PARAMETERS_COUNT_N(_get_counters(), set_value, n_values);
+        std::copy(values, values + n_values, _values.begin());
+        for (size_t idx = 0; idx < n_values; ++idx) {
+            LSST_MODELFIT_PARAMETERS_RECORD(_stats_slot, _get_name(), _label, values[idx]);
+        }
+        if (values_transformed != nullptr) {
+            std::copy(values_transformed, values_transformed + n_values, _values_transformed.begin());
+            _transformed_stale = false;
+        } else {
+            _update_transformed();
+        }
+        ++_version;
+        return penalty;
+    }
+
+public:
+    /// Return a view of the element at a given index
+    std::shared_ptr<Element> get_element(size_t index) {
+        auto& element = _elements.at(index);
+        if (element == nullptr) element = std::make_unique<Element>(*this, index);
+        // The aliasing constructor shares ownership of the array
+        return std::shared_ptr<Element>(this->shared_from_this(), element.get());
+    }
+
+    /// Return views of every element, in order
+    std::vector<std::shared_ptr<ParameterBase<T>>> get_elements() {
+        std::vector<std::shared_ptr<ParameterBase<T>>> elements;
+        elements.reserve(size());
+        for (size_t idx = 0; idx < size(); ++idx) elements.emplace_back(get_element(idx));
+        return elements;
+    }
+
+    /// Return whether the element at a given index is free
+    bool get_free(size_t index) const { return _free.at(index); }
+
+    /// Return the label prefix for elements
+    const std::string& get_label() const { return _label; }
+
+    /// Return the limits for all elements' untransformed values
+    const Limits<T>& get_limits() const { return *_limits; }
+
+    /// Return limits representing the maximum/minimum untransformed value
+    const Limits<T>& get_limits_maximal() const {
+        static const Limits<T> limits_maximal
+                = Limits<T>(_get_min(), _get_max(), std::string(type_name<C>()) + ".limits_maximal",
+                            _get_periodic());
+        return limits_maximal;
+    }
+
+    /// Return the limits for all elements' transformed values
+    const Limits<T>& get_limits_transformed() const { return _limits_transformed; }
+
+    /// Return the transforming function for all elements
+    const Transform<T>& get_transform() const { return *_transform; }
+
+    /// Return the transform pointer for all elements
+    std::shared_ptr<const Transform<T>> get_transform_ptr() const { return _transform_ptr; }
+
+    /// Return the unit of all elements' untransformed values
+    const Unit& get_unit() const { return *_unit_ptr; }
+
+    /// Return the untransformed value of the element at a given index
+    T get_value(size_t index) const { return _values.at(index); }
+
+    /// Return the transformed value of the element at a given index
+    T get_value_transformed(size_t index) const { return get_values_transformed().at(index); }
+
+    /// Return all untransformed values
+    const std::vector<T>& get_values() const { return _values; }
+
+    /// Return all transformed values, computing them all first if any are stale
+    const std::vector<T>& get_values_transformed() const {
+        if (_transformed_stale) _compute_transformed();
+        return _values_transformed;
+    }
+
+    /// Return the version, which is incremented whenever any value is set
+    uint64_t get_version() const { return _version; }
+    /// Return the structure version, which is incremented whenever any free status or the transform changes
+    uint64_t get_version_structure() const { return _version_structure; }
+
+    /// Return whether setting transformed values stores them
+    bool get_transformed_exact() const { return _transformed_exact; }
+
+    /// Return whether transformed values are computed lazily, on first read
+    bool get_transformed_lazy() const { return _transformed_lazy; }
+
+    /// Set whether the element at a given index is free
+    void set_free(size_t index, bool free) {
+        if (free != _free.at(index)) {
+            _free[index] = free;
+            ++_version_structure;
+            ++detail::structure_epoch;
+        }
+    }
+
+    /// Set the label prefix, which does not change existing element labels
+    void set_label(std::string label) {
+        _label = std::move(label);
+#ifdef LSST_MODELFIT_PARAMETERS_STATISTICS
+        _stats_slot.clear();
+#endif
+    }
+
+    /// Set the limits for all elements, checking that all values are within them
+    void set_limits(std::shared_ptr<const Limits<T>> limits) {
+        const auto& limits_maximal = this->get_limits_maximal();
+        if (limits == nullptr) {
+            _limits_ptr = nullptr;
+            _limits = &limits_maximal;
+            _update_limits_transformed();
+            return;
+        }
+        if (!((limits->get_min() >= _get_min()) && (limits->get_max() <= _get_max()))) {
+            LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), throws);
+            throw std::runtime_error(type_name_str<C>() + ".set_limits(" + limits->str()
+                                     + ") sets limits that are less restrictive than the minimum="
+                                     + limits_maximal.str());
+        }
+        for (size_t idx = 0; idx < size(); ++idx) {
+            if (!limits->check(_values[idx])) {
+                LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), throws);
+                throw std::runtime_error(this->str() + ".set_limits(" + limits->str() + ") excludes value["
+                                         + std::to_string(idx) + "]=" + std::to_string(_values[idx]));
+            }
+        }
+        _limits_ptr = std::move(limits);
+        _limits = _limits_ptr.get();
+        _update_limits_transformed();
+    }
+
+    /// Set the transforming function for all elements
+    void set_transform(std::shared_ptr<const Transform<T>> transform) {
+        _set_transform(std::move(transform));
+        ++_version_structure;
+        ++detail::structure_epoch;
+    }
+
+    /// Set whether setting transformed values stores them rather than transforming the reversed values
+    void set_transformed_exact(bool exact) { _transformed_exact = exact; }
+
+    /**
+     * Set whether setting values defers computing transformed values until
+     * any are read, whereupon all are computed in one batch.
+     *
+     * @see ParameterBase::set_transformed_lazy
+     */
+    void set_transformed_lazy(bool lazy) {
+        _transformed_lazy = lazy;
+        if (!lazy && _transformed_stale) _compute_transformed();
+    }
+
+    /// Set the unit for all elements' untransformed values
+    void set_unit(std::shared_ptr<const Unit> unit = nullptr) { _unit_ptr = std::move(unit); }
+
+    /**
+     * Set the untransformed value of the element at a given index.
+     *
+     * @tparam policy The policy for values beyond limits.
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy = LimitPolicy::error>
+    T set_value(size_t index, T value) {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), set_value);
+        const T penalty = _apply_limits<policy>(index, value);
+        _values.at(index) = value;
+        if (_transformed_lazy) {
+            _transformed_stale = true;
+        } else {
+            LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), forward);
+            _values_transformed[index] = _transform->forward(value);
+        }
+        ++_version;
+        LSST_MODELFIT_PARAMETERS_RECORD(_stats_slot, _get_name(), _label, value);
+        return penalty;
+    }
+    /// Set the untransformed value of the element at a given index with a runtime policy
+    T set_value(size_t index, T value, LimitPolicy policy) {
+        return visit_limit_policy(policy, [this, index, value](auto policy_c) {
+            return this->template set_value<decltype(policy_c)::value>(index, value);
+        });
+    }
+
+    /**
+     * Set the untransformed value of the element at a given index along with
+     * its already-computed transformed value.
+     *
+     * @see ParameterBase::set_value_with_transformed
+     */
+    template <LimitPolicy policy = LimitPolicy::error>
+    T set_value_with_transformed(size_t index, T value, T value_transformed) {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), set_value);
+        T value_new = value;
+        const T penalty = _apply_limits<policy>(index, value_new);
+        _values.at(index) = value_new;
+        if (_transformed_exact && (value_new == value)) {
+            // Other elements may still be stale
+            _values_transformed[index] = value_transformed;
+        } else if (_transformed_lazy) {
+            _transformed_stale = true;
+        } else {
+            LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), forward);
+            _values_transformed[index] = _transform->forward(value_new);
+        }
+        ++_version;
+        LSST_MODELFIT_PARAMETERS_RECORD(_stats_slot, _get_name(), _label, value_new);
+        return penalty;
+    }
+    /// Set the untransformed and transformed value of the element at a given index with a runtime policy
+    T set_value_with_transformed(size_t index, T value, T value_transformed, LimitPolicy policy) {
+        return visit_limit_policy(policy, [this, index, value, value_transformed](auto policy_c) {
+            return this->template set_value_with_transformed<decltype(policy_c)::value>(index, value,
+                                                                                        value_transformed);
+        });
+    }
+
+    /**
+     * Set the transformed value of the element at a given index.
+     *
+     * @tparam policy The policy for untransformed values beyond limits.
+     * @return The penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy = LimitPolicy::error>
+    T set_value_transformed(size_t index, T value_transformed) {
+        LSST_MODELFIT_PARAMETERS_COUNT(_get_counters(), reverse);
+        const T value = _transform->reverse(value_transformed);
+        if (_transformed_exact) return set_value_with_transformed<policy>(index, value, value_transformed);
+        return set_value<policy>(index, value);
+    }
+    /// Set the transformed value of the element at a given index with a runtime policy
+    T set_value_transformed(size_t index, T value_transformed, LimitPolicy policy) {
+        return visit_limit_policy(policy, [this, index, value_transformed](auto policy_c) {
+            return this->template set_value_transformed<decltype(policy_c)::value>(index, value_transformed);
+        });
+    }
+
+    /**
+     * Set all untransformed values, checking all before setting any.
+     *
+     * @tparam policy The policy for values beyond limits.
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy = LimitPolicy::error>
+    T set_values(const std::vector<T>& values) {
+        _check_size(values);
+        return _set_values<policy>(values.data());
+    }
+    /// Set all untransformed values with a runtime policy
+    T set_values(const std::vector<T>& values, LimitPolicy policy) {
+        return visit_limit_policy(policy, [this, &values](auto policy_c) {
+            return this->template set_values<decltype(policy_c)::value>(values);
+        });
+    }
+
+    /**
+     * Set all transformed values, checking all before setting any.
+     *
+     * @tparam policy The policy for untransformed values beyond limits.
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    template <LimitPolicy policy = LimitPolicy::error>
+    T set_values_transformed(const std::vector<T>& values_transformed) {
+        _check_size(values_transformed);
+        LSST_MODELFIT_PARAMETERS_COUNT_N(_get_counters(), reverse, size());
+        _transform->reverse_batch(values_transformed.data(), _buffer.data(), size());
+        return _set_values<policy>(_buffer.data(), _transformed_exact ? values_transformed.data() : nullptr);
+    }
+    /// Set all transformed values with a runtime policy
+    T set_values_transformed(const std::vector<T>& values_transformed, LimitPolicy policy) {
+        return visit_limit_policy(policy, [this, &values_transformed](auto policy_c) {
+            return this->template set_values_transformed<decltype(policy_c)::value>(values_transformed);
+        });
+    }
+
+    /// Return the number of elements
+    size_t size() const { return _values.size(); }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        std::string values = "{";
+        for (size_t idx = 0; idx < size(); ++idx) values += (idx ? ", " : "") + std::to_string(_values[idx]);
+        return type_name_str<C>(false, namespace_separator) + "(" + (name_keywords ? "size=" : "")
+               + std::to_string(size()) + ", " + (name_keywords ? "values=" : "") + values + "}, "
+               + (name_keywords ? "limits=" : "") + get_limits().repr(name_keywords, namespace_separator)
+               + ", " + (name_keywords ? "transform=" : "")
+               + get_transform().repr(name_keywords, namespace_separator) + ", "
+               + (name_keywords ? "label='" : "'") + _label + "')";
+    }
+
+    std::string str() const override {
+        return type_name_str<C>(true) + "(size=" + std::to_string(size())
+               + ((_limits == &get_limits_maximal()) ? "" : (", limits=" + get_limits().str()))
+               + ((_transform == &UnitTransform<T>::get()) ? "" : (", transform=" + get_transform().str()))
+               + ((_label == "") ? "" : (", label='" + _label + "'")) + ")";
+    }
+
+    /**
+     * Initialize a ParameterArray.
+     *
+     * @param size The number of elements.
+     * @param value The initial untransformed value of every element.
+     * @param limits The untransformed value limits.
+     * @param transform The transformation to apply to values.
+     * @param unit The unit of the untransformed values.
+     * @param fixed Whether the elements are fixed in models.
+     * @param label A descriptive label prefix for the elements.
+     */
+    explicit ParameterArray(size_t size, T value = _get_default(),
+                            std::shared_ptr<const Limits<T>> limits = nullptr,
+                            std::shared_ptr<const Transform<T>> transform = nullptr,
+                            std::shared_ptr<const Unit> unit = nullptr, bool fixed = false,
+                            std::string label = "")
+            : _values(size, value),
+              _values_transformed(size),
+              _free(size, !fixed),
+              _elements(size),
+              _buffer(size),
+              _label(std::move(label)),
+              _limits(&get_limits_maximal()),
+              _transform(&UnitTransform<T>::get()) {
+        set_limits(std::move(limits));
+        _set_transform(std::move(transform));
+        set_unit(std::move(unit));
+    }
+    ~ParameterArray(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_PARAMETER_ARRAY_H
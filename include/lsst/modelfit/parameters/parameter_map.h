@@ -0,0 +1,109 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_PARAMETER_MAP_H
+#define LSST_MODELFIT_PARAMETERS_PARAMETER_MAP_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "id_table.h"
+#include "object.h"
+#include "parameter.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A sparse side table of values for parameters, keyed by parameter id.
+ *
+ * Values are stored in an open-addressing hash table (with linear probing)
+ * shared with ParameterSet, so storage scales with the number of values
+ * rather than the largest id. This suits long-lived containers whose
+ * parameters may have been created far apart; ParameterTable is a dense
+ * alternative for parameters with nearby ids.
+ *
+ * @tparam T The type of the parameters' values.
+ * @tparam V The type of the values stored for each parameter.
+ */
+template <typename T, typename V>
+class ParameterMap : public Object {
+private:
+    detail::IdTable<V> _table;
+
+public:
+    /// Return the value for a parameter, throwing if it has none
+    const V& at(const ParameterBase<T>& parameter) const {
+        const V* value = _table.find(parameter.get_id());
+        if (value == nullptr) {
+            throw std::out_of_range(this->str() + " has no value for " + parameter.str());
+        }
+        return *value;
+    }
+    /// Return the value for a parameter, throwing if it has none
+    V& at(const ParameterBase<T>& parameter) {
+        return const_cast<V&>(static_cast<const ParameterMap<T, V>&>(*this).at(parameter));
+    }
+
+    /// Return the number of allocated slots, which is at least twice size()
+    size_t capacity() const { return _table.capacity(); }
+
+    /// Remove all values
+    void clear() { _table.clear(); }
+
+    /// Return whether a parameter has a value
+    bool contains(const ParameterBase<T>& parameter) const {
+        return _table.find(parameter.get_id()) != nullptr;
+    }
+
+    /// Remove the value for a parameter, returning whether it had one
+    bool erase(const ParameterBase<T>& parameter) { return _table.erase(parameter.get_id()); }
+
+    /// Reserve space for n values
+    void reserve(size_t n) { _table.reserve(n); }
+
+    /// Set the value for a parameter
+    void set(const ParameterBase<T>& parameter, V value) { (*this)[parameter] = std::move(value); }
+
+    /// Return the number of parameters with values
+    size_t size() const { return _table.size(); }
+
+    /// Return the value for a parameter, default-initializing it if it has none
+    V& operator[](const ParameterBase<T>& parameter) { return _table.get_or_insert(parameter.get_id()); }
+
+    std::string repr(bool = false, const std::string_view& namespace_separator
+                                   = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<ParameterMap<T, V>>(false, namespace_separator) + "()";
+    }
+
+    std::string str() const override {
+        return type_name_str<ParameterMap<T, V>>(true) + "(size=" + std::to_string(_table.size()) + ")";
+    }
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_PARAMETER_MAP_H
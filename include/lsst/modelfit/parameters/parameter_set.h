@@ -0,0 +1,233 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_PARAMETER_SET_H
+#define LSST_MODELFIT_PARAMETERS_PARAMETER_SET_H
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "id_table.h"
+#include "object.h"
+#include "parameter.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A set of unique parameters that iterates in insertion order.
+ *
+ * Parameters are stored in a dense vector, with an open-addressing hash
+ * table (keyed by parameter id, with linear probing, as in ParameterMap) of
+ * indices into it for membership tests. Inserting and finding parameters is O(1) on average
+ * and allocates only when either grows.
+ *
+ * @tparam T The type of the parameters' values.
+ */
+template <typename T>
+class ParameterSet : public Object {
+public:
+    using ParamPtr = std::shared_ptr<ParameterBase<T>>;
+    using const_iterator = typename std::vector<ParamPtr>::const_iterator;
+
+private:
+    std::vector<ParamPtr> _parameters;
+    /// The index into _parameters of each parameter, by id
+    detail::IdTable<size_t> _indices;
+
+    void _check_size(const std::vector<T>& values) const {
+        if (values.size() != _parameters.size()) {
+            throw std::invalid_argument(this->str() + " given values.size()=" + std::to_string(values.size())
+                                        + " != size()=" + std::to_string(_parameters.size()));
+        }
+    }
+
+public:
+    /**
+     * Add a parameter if it is not already in the set.
+     *
+     * @return Whether the parameter was added.
+     */
+    bool add(const ParamPtr& parameter) {
+        if (parameter == nullptr) throw std::invalid_argument(this->str() + " can't add a null parameter");
+        bool inserted;
+        size_t& index = _indices.get_or_insert(parameter->get_id(), &inserted);
+        if (!inserted) return false;
+        index = _parameters.size();
+        _parameters.push_back(parameter);
+        return true;
+    }
+
+    /**
+     * Add each of a range of parameters that is not already in the set.
+     *
+     * @return The number of parameters added.
+     */
+    template <typename Iterable>
+    size_t add_all(const Iterable& parameters) {
+        size_t n_added = 0;
+        for (const auto& parameter : parameters) n_added += add(parameter);
+        return n_added;
+    }
+
+    const_iterator begin() const { return _parameters.begin(); }
+    const_iterator end() const { return _parameters.end(); }
+
+    /// Remove all parameters
+    void clear() {
+        _parameters.clear();
+        _indices.clear();
+    }
+
+    /// Return whether a parameter is in the set
+    bool contains(const ParameterBase<T>& parameter) const {
+        return _indices.find(parameter.get_id()) != nullptr;
+    }
+
+    /// Return whether the set is empty
+    bool empty() const { return _parameters.empty(); }
+
+    /**
+     * Remove a parameter, preserving the order of the others.
+     *
+     * This is O(n), since subsequent parameters are moved and their indices
+     * decremented.
+     *
+     * @return Whether the parameter was removed.
+     */
+    bool erase(const ParameterBase<T>& parameter) {
+        const size_t* found = _indices.find(parameter.get_id());
+        if (found == nullptr) return false;
+        const size_t index = *found;
+        _indices.erase(parameter.get_id());
+        _parameters.erase(_parameters.begin() + index);
+        const size_t n_params = _parameters.size();
+        for (size_t idx = index; idx < n_params; ++idx) --*_indices.find(_parameters[idx]->get_id());
+        return true;
+    }
+
+    /// Return a new set of the parameters for which predicate(parameter) is true, in order
+    template <typename Predicate>
+    ParameterSet<T> filter(Predicate&& predicate) const {
+        ParameterSet<T> filtered;
+        for (const auto& parameter : _parameters) {
+            if (predicate(*parameter)) filtered.add(parameter);
+        }
+        return filtered;
+    }
+
+    /// Return a new set of the free parameters
+    ParameterSet<T> get_free() const {
+        return filter([](const ParameterBase<T>& parameter) { return parameter.get_free(); });
+    }
+
+    /// Return a new set of the linear parameters
+    ParameterSet<T> get_linear() const {
+        return filter([](const ParameterBase<T>& parameter) { return parameter.get_linear(); });
+    }
+
+    /// Return the parameters in insertion order
+    const std::vector<ParamPtr>& get_parameters() const { return _parameters; }
+
+    /// Return a new set of the parameters of (or derived from) type P
+    template <typename P>
+    ParameterSet<T> get_type() const {
+        return filter([](const ParameterBase<T>& parameter) {
+            return dynamic_cast<const P*>(&parameter) != nullptr;
+        });
+    }
+
+    /// Write the untransformed values of the parameters to values
+    void get_values(std::vector<T>& values) const {
+        _check_size(values);
+        const size_t n_params = _parameters.size();
+        for (size_t idx = 0; idx < n_params; ++idx) values[idx] = _parameters[idx]->get_value();
+    }
+
+    /// Reserve space for n parameters
+    void reserve(size_t n) {
+        _parameters.reserve(n);
+        _indices.reserve(n);
+    }
+
+    /// Set every parameter to be fixed (or not)
+    void set_fixed(bool fixed) {
+        for (const auto& parameter : _parameters) parameter->set_fixed(fixed);
+    }
+
+    /// Set every parameter to be free (or not)
+    void set_free(bool free) {
+        for (const auto& parameter : _parameters) parameter->set_free(free);
+    }
+
+    /**
+     * Set the untransformed values of the parameters.
+     *
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T set_values(const std::vector<T>& values, LimitPolicy policy = LimitPolicy::error) {
+        _check_size(values);
+        const size_t n_params = _parameters.size();
+        T penalty = 0;
+        for (size_t idx = 0; idx < n_params; ++idx) {
+            penalty += _parameters[idx]->set_value(values[idx], policy);
+        }
+        return penalty;
+    }
+
+    /// Return the number of parameters
+    size_t size() const { return _parameters.size(); }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        std::string result = type_name_str<ParameterSet<T>>(false, namespace_separator) + "("
+                             + (name_keywords ? "parameters=" : "") + "[";
+        for (const auto& parameter : _parameters) {
+            result += parameter->repr(name_keywords, namespace_separator) + ", ";
+        }
+        return result + "])";
+    }
+
+    std::string str() const override {
+        return type_name_str<ParameterSet<T>>(true) + "(size=" + std::to_string(_parameters.size()) + ")";
+    }
+
+    /**
+     * Initialize a ParameterSet.
+     *
+     * @param parameters The parameters to add, in order, ignoring duplicates.
+     */
+    explicit ParameterSet(const std::vector<ParamPtr>& parameters = {}) {
+        reserve(parameters.size());
+        add_all(parameters);
+    }
+    ~ParameterSet(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_PARAMETER_SET_H
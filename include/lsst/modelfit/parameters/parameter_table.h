@@ -0,0 +1,131 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_PARAMETER_TABLE_H
+#define LSST_MODELFIT_PARAMETERS_PARAMETER_TABLE_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "object.h"
+#include "parameter.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A side table of values for parameters, indexed by parameter id.
+ *
+ * Lookups are a vector index rather than a tree or hash lookup. Storage
+ * grows to the largest id set and ids are never reused, so tables are only
+ * suited to short-lived use with parameters created around the same time
+ * (e.g. those of one model). Use ParameterMap for long-lived containers.
+ *
+ * @tparam T The type of the parameters' values.
+ * @tparam V The type of the values stored for each parameter. This can't be
+ *      bool, since std::vector<bool> can't return references to values.
+ */
+template <typename T, typename V>
+class ParameterTable : public Object {
+private:
+    std::vector<V> _values;
+    /// Whether each id has a value set
+    std::vector<bool> _is_set;
+    size_t _size = 0;
+
+    void _reserve_id(size_t id) {
+        if (!(id < _values.size())) {
+            _values.resize(id + 1);
+            _is_set.resize(id + 1, false);
+        }
+    }
+
+public:
+    /// Return the value for a parameter, throwing if it has none
+    const V& at(const ParameterBase<T>& parameter) const {
+        if (!contains(parameter)) {
+            throw std::out_of_range(this->str() + " has no value for " + parameter.str());
+        }
+        return _values[parameter.get_id()];
+    }
+    /// Return the value for a parameter, throwing if it has none
+    V& at(const ParameterBase<T>& parameter) {
+        return const_cast<V&>(static_cast<const ParameterTable<T, V>&>(*this).at(parameter));
+    }
+
+    /// Remove all values
+    void clear() {
+        _values.clear();
+        _is_set.clear();
+        _size = 0;
+    }
+
+    /// Return whether a parameter has a value
+    bool contains(const ParameterBase<T>& parameter) const {
+        const size_t id = parameter.get_id();
+        return (id < _is_set.size()) && _is_set[id];
+    }
+
+    /// Remove the value for a parameter, returning whether it had one
+    bool erase(const ParameterBase<T>& parameter) {
+        if (!contains(parameter)) return false;
+        const size_t id = parameter.get_id();
+        _values[id] = V();
+        _is_set[id] = false;
+        --_size;
+        return true;
+    }
+
+    /// Set the value for a parameter
+    void set(const ParameterBase<T>& parameter, V value) { (*this)[parameter] = std::move(value); }
+
+    /// Return the number of parameters with values
+    size_t size() const { return _size; }
+
+    /// Return the value for a parameter, default-initializing it if it has none
+    V& operator[](const ParameterBase<T>& parameter) {
+        const size_t id = parameter.get_id();
+        _reserve_id(id);
+        if (!_is_set[id]) {
+            _is_set[id] = true;
+            ++_size;
+        }
+        return _values[id];
+    }
+
+    std::string repr(bool = false, const std::string_view& namespace_separator
+                                   = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<ParameterTable<T, V>>(false, namespace_separator) + "()";
+    }
+
+    std::string str() const override {
+        return type_name_str<ParameterTable<T, V>>(true) + "(size=" + std::to_string(_size) + ")";
+    }
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_PARAMETER_TABLE_H
@@ -0,0 +1,246 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_REDUCED_PROBLEM_H
+#define LSST_MODELFIT_PARAMETERS_REDUCED_PROBLEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "collection.h"
+#include "limits.h"
+#include "object.h"
+#include "parameter.h"
+#include "transform.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A view of the free parameters of a ParameterCollection, compiled
+ * for repeated evaluation.
+ *
+ * Compiling stores the free (and untied) parameters with dense indices, in
+ * the same order as the collection's free values, and packs the values of
+ * fixed parameters into an array of constants. Free parameters sharing a
+ * Transform are grouped into plans, so that transformed values can be
+ * reversed in one batch per transform.
+ *
+ * The view is invalidated when the free status or transform of any of the
+ * collection's parameters changes, or when the collection adds parameters,
+ * ties or groups; setting values (or changing other parameters) does not
+ * invalidate it. Methods using the view throw if it is no
+ * longer valid, after which compile must be called again.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ *
+ * @note The packed fixed values are copied when compiling and are not
+ * updated if fixed parameters' values are changed.
+ */
+template <typename T>
+class ReducedProblem : public Object {
+public:
+    using ParamPtr = std::shared_ptr<ParameterBase<T>>;
+    using TransformPlan = typename ParameterCollection<T>::TransformPlan;
+
+private:
+    ParameterCollection<T>& _collection;
+    /// The free (and untied) parameters
+    std::vector<ParamPtr> _parameters_free;
+    /// The index in the collection of each free parameter
+    std::vector<size_t> _indices_free;
+    /// The index in the collection of each fixed parameter
+    std::vector<size_t> _indices_fixed;
+    /// The untransformed values of the fixed parameters when compiled
+    std::vector<T> _values_fixed;
+    std::vector<TransformPlan> _plans;
+    /// Buffers for batch transforms
+    std::vector<T> _buffer;
+    std::vector<T> _buffer_transformed;
+    /// ParameterCollection::get_structure_version() when compiled
+    uint64_t _version_collection = 0;
+    /// ParameterCollection::get_structure_version_parameters() when compiled
+    uint64_t _version_parameters = 0;
+
+    void _check_size(const std::vector<T>& values) const {
+        if (values.size() != _parameters_free.size()) {
+            throw std::invalid_argument(this->str() + " given values.size()=" + std::to_string(values.size())
+                                        + " != n_free=" + std::to_string(_parameters_free.size()));
+        }
+    }
+
+    void _check_valid() const {
+        if (!is_valid()) {
+            throw std::logic_error(this->str() + " is invalid because free parameters, transforms or "
+                                   "ties have changed; call compile() again");
+        }
+    }
+
+public:
+    /**
+     * Rebuild this view from the current state of the collection.
+     *
+     * @throws std::logic_error If the collection has vector transform groups,
+     *      which are not supported.
+     */
+    void compile() {
+        if (!_collection.get_vector_transforms().empty()) {
+            throw std::logic_error(this->str() + " can't compile a collection with vector transforms");
+        }
+        _version_collection = _collection.get_structure_version();
+        _version_parameters = _collection.get_structure_version_parameters();
+
+        const auto& parameters = _collection.get_parameters();
+        const auto& is_dependent = _collection.get_is_dependent();
+        const size_t n_params = parameters.size();
+
+        _parameters_free.clear();
+        _indices_free.clear();
+        _indices_fixed.clear();
+        _values_fixed.clear();
+        for (size_t idx = 0; idx < n_params; ++idx) {
+            const auto& parameter = parameters[idx];
+            if (parameter->get_fixed()) {
+                _indices_fixed.push_back(idx);
+                _values_fixed.push_back(parameter->get_value());
+            } else if (!is_dependent[idx]) {
+                _parameters_free.push_back(parameter);
+                _indices_free.push_back(idx);
+            }
+        }
+        // Copy the collection's plans, which it may recompute after this is invalidated
+        _plans = _collection.get_plans();
+        _buffer.resize(_parameters_free.size());
+        _buffer_transformed.resize(_parameters_free.size());
+    }
+
+    /// Return the index in the collection of each fixed parameter
+    const std::vector<size_t>& get_indices_fixed() const { return _indices_fixed; }
+    /// Return the index in the collection of each free parameter
+    const std::vector<size_t>& get_indices_free() const { return _indices_free; }
+    /// Return the number of free (and untied) parameters
+    size_t get_n_free() const { return _parameters_free.size(); }
+    /// Return the free (and untied) parameters
+    const std::vector<ParamPtr>& get_parameters_free() const { return _parameters_free; }
+    /// Return the plans for transforming free parameters, one per distinct transform
+    const std::vector<TransformPlan>& get_plans() const { return _plans; }
+    /// Return the untransformed values of the fixed parameters when compiled
+    const std::vector<T>& get_values_fixed() const { return _values_fixed; }
+
+    /// Write the untransformed values of the free parameters to values
+    void get_values(std::vector<T>& values) const {
+        _check_valid();
+        _check_size(values);
+        const size_t n_free = _parameters_free.size();
+        for (size_t idx = 0; idx < n_free; ++idx) values[idx] = _parameters_free[idx]->get_value();
+    }
+
+    /// Write the transformed values of the free parameters to values
+    void get_values_transformed(std::vector<T>& values) const {
+        _check_valid();
+        _check_size(values);
+        const size_t n_free = _parameters_free.size();
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            values[idx] = _parameters_free[idx]->get_value_transformed();
+        }
+    }
+
+    /// Return whether no free status, transform or collection structure has changed since compiling
+    bool is_valid() const {
+        return (_version_collection == _collection.get_structure_version())
+               && (_version_parameters == _collection.get_structure_version_parameters());
+    }
+
+    /**
+     * Set the untransformed values of the free parameters and update ties.
+     *
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T set_values(const std::vector<T>& values, LimitPolicy policy = LimitPolicy::error) {
+        _check_valid();
+        _check_size(values);
+        T penalty = 0;
+        const size_t n_free = _parameters_free.size();
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            penalty += _parameters_free[idx]->set_value(values[idx], policy);
+        }
+        penalty += _collection.update_ties(policy);
+        return penalty;
+    }
+
+    /**
+     * Set the transformed values of the free parameters and update ties.
+     *
+     * Values are reversed in one batch per plan, and the given transformed
+     * values are stored without transforming the reversed values again for
+     * parameters with exact transformed values enabled (see
+     * ParameterBase::set_value_with_transformed).
+     *
+     * @return The total penalty for LimitPolicy::penalize, or else zero.
+     */
+    T set_values_transformed(const std::vector<T>& values, LimitPolicy policy = LimitPolicy::error) {
+        _check_valid();
+        _check_size(values);
+        T penalty = 0;
+        for (const auto& plan : _plans) {
+            const size_t n_values = plan.indices_free.size();
+            for (size_t k = 0; k < n_values; ++k) _buffer_transformed[k] = values[plan.indices_free[k]];
+            plan.transform->reverse_batch(_buffer_transformed.data(), _buffer.data(), n_values);
+            for (size_t k = 0; k < n_values; ++k) {
+                penalty += plan.parameters[k]->set_value_with_transformed(_buffer[k], _buffer_transformed[k],
+                                                                          policy);
+            }
+        }
+        penalty += _collection.update_ties(policy);
+        return penalty;
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<ReducedProblem<T>>(false, namespace_separator) + "("
+               + (name_keywords ? "collection=" : "") + _collection.repr(name_keywords, namespace_separator)
+               + ")";
+    }
+
+    std::string str() const override {
+        return type_name_str<ReducedProblem<T>>(true) + "(n_free=" + std::to_string(_parameters_free.size())
+               + ", n_fixed=" + std::to_string(_indices_fixed.size())
+               + ", n_plans=" + std::to_string(_plans.size()) + ")";
+    }
+
+    /**
+     * Compile a ReducedProblem.
+     *
+     * @param collection The collection to view, which must outlive this.
+     */
+    explicit ReducedProblem(ParameterCollection<T>& collection) : _collection(collection) { compile(); }
+    ~ReducedProblem(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_REDUCED_PROBLEM_H
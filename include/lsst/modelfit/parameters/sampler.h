@@ -0,0 +1,252 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_SAMPLER_H
+#define LSST_MODELFIT_PARAMETERS_SAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "collection.h"
+#include "limits.h"
+#include "object.h"
+#include "parameter.h"
+#include "parameter_map.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+namespace detail {
+/// Return a well-mixed 64-bit hash of x (the splitmix64 finalizer)
+inline uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/// Return a uniform random number in [0, 1) for a stream key and a counter
+inline double uniform_counter(uint64_t key, uint64_t counter) {
+    return double(mix64(key ^ mix64(counter)) >> 11) * 0x1.0p-53;
+}
+}  // namespace detail
+
+/**
+ * @brief Draws random transformed values for the free parameters of a
+ * ParameterCollection, e.g. for initializing multi-start fits or samplers.
+ *
+ * Random numbers are counter-based: each is a hash of the seed, the
+ * parameter's id, a stream (e.g. a thread index) and the draw number. Draws
+ * are therefore reproducible, independent of the order in which they are
+ * made and safe to make concurrently without shared state.
+ *
+ * With Distribution::uniform, values are uniform within each parameter's
+ * transformed-space limits, intersected with the current value plus or minus
+ * the parameter's scale. With Distribution::normal, values are the current
+ * value plus a Gaussian jitter with a standard deviation of the scale,
+ * reflected back within the limits. Scales default to infinity for uniform
+ * sampling (i.e. the full limits, which must then be finite) and to one for
+ * normal sampling.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+class ParameterSampler : public Object {
+public:
+    using ParamPtr = std::shared_ptr<ParameterBase<T>>;
+
+    /// The distribution of transformed values to sample from
+    enum class Distribution { uniform, normal };
+
+private:
+    ParameterCollection<T>& _collection;
+    uint64_t _seed;
+    Distribution _distribution;
+    /// The scale for each parameter, if not the distribution's default
+    ParameterMap<T, T> _scales;
+
+    std::vector<ParamPtr> _get_free() const {
+        if (!_collection.get_vector_transforms().empty()) {
+            throw std::logic_error(this->str() + " does not support collections with vector transforms");
+        }
+        return _collection.get_parameters_free();
+    }
+
+    /// Return the key for the random numbers of a parameter and stream
+    uint64_t _get_key(const ParameterBase<T>& parameter, uint64_t stream) const {
+        return detail::mix64(_seed ^ detail::mix64(parameter.get_id() ^ detail::mix64(~stream)));
+    }
+
+    /**
+     * Write n_draws samples for one parameter to out with a given stride.
+     *
+     * The random numbers are generated without branching, so that the
+     * loops can be vectorized.
+     */
+    void _sample_parameter(const ParameterBase<T>& parameter, uint64_t stream, uint64_t draw_first,
+                           size_t n_draws, T* out, size_t stride, std::vector<double>& buffer) const {
+        const uint64_t key = _get_key(parameter, stream);
+        const T value = parameter.get_value_transformed();
+        const T scale = get_scale(parameter);
+        const auto& limits = parameter.get_limits_transformed();
+        if (!std::isfinite(scale) && (_distribution == Distribution::normal)) {
+            throw std::invalid_argument(this->str() + " can't sample normal jitter with infinite scale for "
+                                        + parameter.str());
+        }
+        buffer.resize(2 * n_draws);
+        for (size_t idx = 0; idx < 2 * n_draws; ++idx) {
+            buffer[idx] = detail::uniform_counter(key, 2 * draw_first + idx);
+        }
+        if (_distribution == Distribution::uniform) {
+            const T min = std::max(limits.get_min(), value - scale);
+            const T max = std::min(limits.get_max(), value + scale);
+            const T width = max - min;
+            if (!std::isfinite(width)) {
+                throw std::invalid_argument(this->str() + " can't sample uniformly within infinite range ["
+                                            + std::to_string(min) + ", " + std::to_string(max) + "] for "
+                                            + parameter.str());
+            }
+            for (size_t idx = 0; idx < n_draws; ++idx) {
+                // Clip to guard against rounding up to max + ulp
+                out[idx * stride] = limits.clip(min + width * T(buffer[2 * idx]));
+            }
+        } else {
+            constexpr double two_pi = 6.283185307179586476925286766559;
+            for (size_t idx = 0; idx < n_draws; ++idx) {
+                // Box-Muller, with 1 - u in (0, 1] to avoid log(0)
+                const double normal = std::sqrt(-2 * std::log(1 - buffer[2 * idx]))
+                                      * std::cos(two_pi * buffer[2 * idx + 1]);
+                out[idx * stride] = value + scale * T(normal);
+            }
+            for (size_t idx = 0; idx < n_draws; ++idx) out[idx * stride] = limits.reflect(out[idx * stride]);
+        }
+    }
+
+public:
+    /// Return the distribution to sample from
+    Distribution get_distribution() const { return _distribution; }
+    /// Return the number of free parameters, i.e. the number of values in each draw
+    size_t get_n_free() const { return _collection.get_n_free(); }
+    /// Return the scale for a parameter, which is infinite for uniform or else one by default
+    T get_scale(const ParameterBase<T>& parameter) const {
+        if (_scales.contains(parameter)) return _scales.at(parameter);
+        return (_distribution == Distribution::uniform) ? std::numeric_limits<T>::infinity() : T(1);
+    }
+    /// Return the seed
+    uint64_t get_seed() const { return _seed; }
+
+    /**
+     * Write random transformed values for the free parameters to values.
+     *
+     * @param values The output values, row-major with get_n_free() values
+     *      for each draw.
+     * @param draw_first The number of the first draw.
+     * @param n_draws The number of draws.
+     * @param stream The random number stream, e.g. a thread index.
+     */
+    void sample(std::vector<T>& values, uint64_t draw_first = 0, size_t n_draws = 1,
+                uint64_t stream = 0) const {
+        const auto free = _get_free();
+        const size_t n_free = free.size();
+        if (values.size() != n_free * n_draws) {
+            throw std::invalid_argument(this->str() + " given values.size()=" + std::to_string(values.size())
+                                        + " != n_free*n_draws=" + std::to_string(n_free * n_draws));
+        }
+        std::vector<double> buffer;
+        for (size_t idx = 0; idx < n_free; ++idx) {
+            _sample_parameter(*free[idx], stream, draw_first, n_draws, values.data() + idx, n_free, buffer);
+        }
+    }
+
+    /**
+     * Set the free parameters' transformed values to a random draw.
+     *
+     * Values reversed to just beyond limits by rounding are clipped.
+     *
+     * @param draw The number of the draw.
+     * @param stream The random number stream, e.g. a thread index.
+     */
+    void set_sample(uint64_t draw = 0, uint64_t stream = 0) {
+        std::vector<T> values(_collection.get_n_free());
+        sample(values, draw, 1, stream);
+        _collection.set_values_transformed(values, LimitPolicy::clip);
+    }
+
+    /// Set the distribution to sample from
+    void set_distribution(Distribution distribution) { _distribution = distribution; }
+    /**
+     * Set the scale for a parameter.
+     *
+     * @param parameter The parameter.
+     * @param scale The standard deviation of normal jitter, or the half-width
+     *      of the uniform range, in transformed values. It must be positive
+     *      and may only be infinite for uniform sampling within finite limits.
+     */
+    void set_scale(const ParameterBase<T>& parameter, T scale) {
+        if (!(scale > 0)) {
+            throw std::invalid_argument(this->str() + " given invalid scale=" + std::to_string(scale)
+                                        + " for " + parameter.str());
+        }
+        _scales.set(parameter, scale);
+    }
+    /// Set the seed
+    void set_seed(uint64_t seed) { _seed = seed; }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<ParameterSampler<T>>(false, namespace_separator) + "("
+               + (name_keywords ? "collection=" : "") + _collection.repr(name_keywords, namespace_separator)
+               + ", " + (name_keywords ? "seed=" : "") + std::to_string(_seed) + ", "
+               + (name_keywords ? "distribution=" : "") + std::to_string(static_cast<int>(_distribution))
+               + ")";
+    }
+
+    std::string str() const override {
+        return type_name_str<ParameterSampler<T>>(true) + "(seed=" + std::to_string(_seed)
+               + ", distribution="
+               + (_distribution == Distribution::uniform ? "uniform" : "normal") + ")";
+    }
+
+    /**
+     * Initialize a ParameterSampler.
+     *
+     * @param collection The collection to sample (and set) values for,
+     *      which must outlive this.
+     * @param seed The seed for all random number streams.
+     * @param distribution The distribution to sample from.
+     */
+    explicit ParameterSampler(ParameterCollection<T>& collection, uint64_t seed = 0,
+                              Distribution distribution = Distribution::uniform)
+            : _collection(collection), _seed(seed), _distribution(distribution) {}
+    ~ParameterSampler(){};
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_SAMPLER_H
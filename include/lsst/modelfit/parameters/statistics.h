@@ -0,0 +1,322 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_STATISTICS_H
+#define LSST_MODELFIT_PARAMETERS_STATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Observed-value statistics are compiled out unless this macro is defined
+ * before including any parameters header, e.g. with
+ * -DLSST_MODELFIT_PARAMETERS_STATISTICS. All translation units in a program
+ * should be compiled with the same setting.
+ *
+ * Each parameter caches a pointer to its statistics, so recording a value
+ * only allocates the first time a parameter sets a value in a thread, or
+ * after a label change or registry reset.
+ */
+#ifdef LSST_MODELFIT_PARAMETERS_STATISTICS
+#define LSST_MODELFIT_PARAMETERS_RECORD(slot, name, label, value) \
+    (::lsst::modelfit::parameters::record_value((slot), (name), (label), (value)))
+#else
+#define LSST_MODELFIT_PARAMETERS_RECORD(slot, name, label, value) ((void)0)
+#endif
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * Streaming statistics of observed values.
+ *
+ * The mean and variance are computed with Welford's algorithm. The
+ * histogram has log-spaced bins of absolute values, separately for positive
+ * and negative values; values beyond the range of the bins are counted in
+ * the first or last bin.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+struct ValueStatistics {
+    /// The base 10 log of the lower edge of the first histogram bin
+    static constexpr int DECADE_MIN = -16;
+    /// The base 10 log of the upper edge of the last histogram bin
+    static constexpr int DECADE_MAX = 16;
+    /// The number of histogram bins per factor of 10
+    static constexpr int BINS_PER_DECADE = 4;
+    /// The number of histogram bins for each sign
+    static constexpr size_t N_BINS = (DECADE_MAX - DECADE_MIN) * BINS_PER_DECADE;
+
+    /// The number of finite values
+    uint64_t n = 0;
+    /// The number of values equal to zero
+    uint64_t n_zero = 0;
+    /// The number of non-finite values, which are otherwise ignored
+    uint64_t n_nonfinite = 0;
+    T min = std::numeric_limits<T>::infinity();
+    T max = -std::numeric_limits<T>::infinity();
+    T mean = 0;
+    /// The sum of squared differences from the mean
+    T m2 = 0;
+    std::array<uint64_t, N_BINS> histogram_positive{};
+    std::array<uint64_t, N_BINS> histogram_negative{};
+
+    /// Return the histogram bin index for a finite, non-zero value
+    static size_t get_bin(T value) {
+        const T bin = std::floor((std::log10(std::abs(value)) - DECADE_MIN) * BINS_PER_DECADE);
+        return bin < 0 ? 0 : std::min(static_cast<size_t>(bin), N_BINS - 1);
+    }
+
+    /// Return the lower edge of the absolute value of a histogram bin
+    static T get_bin_edge(size_t bin) {
+        return std::pow(T(10), DECADE_MIN + T(bin) / BINS_PER_DECADE);
+    }
+
+    /// Return the unbiased sample variance
+    T get_variance() const { return n > 1 ? m2 / (n - 1) : 0; }
+
+    /// Add a value
+    void add(T value) {
+        if (!std::isfinite(value)) {
+            ++n_nonfinite;
+            return;
+        }
+        ++n;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        const T delta = value - mean;
+        mean += delta / n;
+        m2 += delta * (value - mean);
+        if (value == 0) {
+            ++n_zero;
+        } else {
+            (value > 0 ? histogram_positive : histogram_negative)[get_bin(value)]++;
+        }
+    }
+
+    /// Merge statistics from another instance
+    void merge(const ValueStatistics<T>& other) {
+        if (other.n > 0) {
+            const uint64_t n_total = n + other.n;
+            const T delta = other.mean - mean;
+            mean += delta * other.n / n_total;
+            m2 += other.m2 + delta * delta * (T(n) * other.n / n_total);
+            n = n_total;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+        }
+        n_zero += other.n_zero;
+        n_nonfinite += other.n_nonfinite;
+        for (size_t bin = 0; bin < N_BINS; ++bin) {
+            histogram_positive[bin] += other.histogram_positive[bin];
+            histogram_negative[bin] += other.histogram_negative[bin];
+        }
+    }
+
+    /// Return a JSON object string of these statistics, omitting empty bins
+    std::string str() const {
+        std::string result = "{\"n\": " + std::to_string(n) + ", \"n_zero\": " + std::to_string(n_zero)
+                             + ", \"n_nonfinite\": " + std::to_string(n_nonfinite);
+        if (n > 0) {
+            result += ", \"min\": " + std::to_string(min) + ", \"max\": " + std::to_string(max)
+                      + ", \"mean\": " + std::to_string(mean)
+                      + ", \"variance\": " + std::to_string(get_variance());
+        }
+        auto add_histogram = [&result](const std::string& name,
+                                       const std::array<uint64_t, N_BINS>& histogram) {
+            result += ", \"" + name + "\": {";
+            bool first = true;
+            for (size_t bin = 0; bin < N_BINS; ++bin) {
+                if (histogram[bin] == 0) continue;
+                result += (first ? "\"" : ", \"") + std::to_string(get_bin_edge(bin))
+                          + "\": " + std::to_string(histogram[bin]);
+                first = false;
+            }
+            result += "}";
+        };
+        add_histogram("histogram_positive", histogram_positive);
+        add_histogram("histogram_negative", histogram_negative);
+        return result + "}";
+    }
+};
+
+/**
+ * A cached location of a parameter's ValueStatistics in a registry shard.
+ *
+ * The cache is valid only for the shard and registry generation it was
+ * filled for, and must be cleared if the parameter's label changes.
+ */
+template <typename T>
+struct ValueStatisticsSlot {
+    ValueStatistics<T>* stats = nullptr;
+    const void* shard = nullptr;
+    uint64_t generation = 0;
+
+    /// Invalidate the cached location
+    void clear() { stats = nullptr; }
+};
+
+/**
+ * A global registry of ValueStatistics, keyed by parameter name and label.
+ *
+ * Each thread records into its own shard without locking. Shards are merged
+ * on demand, which (like reset) must only be done while no other threads
+ * are recording values.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+class ValueStatisticsRegistry {
+public:
+    /// Statistics keyed by parameter label
+    using LabelMap = std::map<std::string, ValueStatistics<T>, std::less<>>;
+    /// Statistics keyed by parameter name, then label
+    using NameMap = std::map<std::string, LabelMap, std::less<>>;
+
+private:
+    /// The number of resets, which invalidate cached slots
+    static std::atomic<uint64_t>& _get_generation() {
+        static std::atomic<uint64_t> generation = 0;
+        return generation;
+    }
+    static std::mutex& _get_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static std::vector<std::shared_ptr<NameMap>>& _get_shards() {
+        static std::vector<std::shared_ptr<NameMap>> shards;
+        return shards;
+    }
+    // Shards are owned by the registry, so their statistics outlive threads
+    static NameMap& _get_shard() {
+        thread_local std::shared_ptr<NameMap> shard = [] {
+            auto shard_new = std::make_shared<NameMap>();
+            std::lock_guard<std::mutex> lock(_get_mutex());
+            _get_shards().push_back(shard_new);
+            return shard_new;
+        }();
+        return *shard;
+    }
+    /// Return the statistics for a given parameter name and label in a shard, adding them if needed
+    static ValueStatistics<T>& _find(NameMap& shard, const std::string& name, const std::string& label) {
+        auto found_name = shard.find(name);
+        if (found_name == shard.end()) found_name = shard.try_emplace(name).first;
+        auto& labels = found_name->second;
+        auto found_label = labels.find(label);
+        if (found_label == labels.end()) found_label = labels.try_emplace(label).first;
+        return found_label->second;
+    }
+
+public:
+    /// Record a value for a given parameter name and label in this thread's shard
+    static void record(const std::string& name, const std::string& label, T value) {
+        _find(_get_shard(), name, label).add(value);
+    }
+    /**
+     * Record a value for a given parameter name and label in this thread's
+     * shard, reusing the location cached in slot if it is still valid.
+     */
+    static void record(ValueStatisticsSlot<T>& slot, const std::string& name, const std::string& label,
+                       T value) {
+        auto& shard = _get_shard();
+        const uint64_t generation = _get_generation().load(std::memory_order_relaxed);
+        if ((slot.stats == nullptr) || (slot.shard != &shard) || (slot.generation != generation)) {
+            slot.stats = &_find(shard, name, label);
+            slot.shard = &shard;
+            slot.generation = generation;
+        }
+        slot.stats->add(value);
+    }
+
+    /// Return statistics merged from all threads
+    static NameMap merge() {
+        std::lock_guard<std::mutex> lock(_get_mutex());
+        NameMap merged;
+        for (const auto& shard : _get_shards()) {
+            for (const auto& [name, labels] : *shard) {
+                auto& labels_merged = merged[name];
+                for (const auto& [label, stats] : labels) labels_merged[label].merge(stats);
+            }
+        }
+        return merged;
+    }
+
+    /// Return statistics merged from all threads and labels, keyed by parameter name
+    static std::map<std::string, ValueStatistics<T>> merge_labels() {
+        std::map<std::string, ValueStatistics<T>> merged;
+        for (const auto& [name, labels] : merge()) {
+            auto& stats_merged = merged[name];
+            for (const auto& [label, stats] : labels) stats_merged.merge(stats);
+        }
+        return merged;
+    }
+
+    /// Return a JSON object string of merged statistics, keyed by name and then label
+    static std::string report() {
+        std::string result = "{";
+        bool first_name = true;
+        for (const auto& [name, labels] : merge()) {
+            result += (first_name ? "\"" : ", \"") + name + "\": {";
+            bool first_label = true;
+            for (const auto& [label, stats] : labels) {
+                result += (first_label ? "\"" : ", \"") + label + "\": " + stats.str();
+                first_label = false;
+            }
+            result += "}";
+            first_name = false;
+        }
+        return result + "}";
+    }
+
+    /// Clear the statistics of all threads, invalidating all cached slots
+    static void reset() {
+        std::lock_guard<std::mutex> lock(_get_mutex());
+        for (auto& shard : _get_shards()) shard->clear();
+        ++_get_generation();
+    }
+};
+
+/// Record a value for a given parameter name and label
+template <typename T>
+void record_value(const std::string& name, const std::string& label, T value) {
+    ValueStatisticsRegistry<T>::record(name, label, value);
+}
+
+/// Record a value for a given parameter name and label, caching its location in slot
+template <typename T>
+void record_value(ValueStatisticsSlot<T>& slot, const std::string& name, const std::string& label, T value) {
+    ValueStatisticsRegistry<T>::record(slot, name, label, value);
+}
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_STATISTICS_H
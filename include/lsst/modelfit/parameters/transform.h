@@ -25,8 +25,11 @@
 #ifndef LSST_MODELFIT_PARAMETERS_TRANSFORM_H
 #define LSST_MODELFIT_PARAMETERS_TRANSFORM_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 #include "object.h"
@@ -38,6 +41,12 @@ namespace lsst::modelfit::parameters {
  * @brief A reversible transformation of a real scalar value.
  *
  * The transformation should be differentiable, ideally analytically.
+ * Implementing the second derivative is optional, but is required for
+ * converting Hessians to the transformed space.
+ *
+ * The batch (*_batch) methods evaluate n values at once and may be overridden
+ * with tighter loops than the default, which calls the scalar method for each
+ * value.
  *
  * @tparam T The type of the value. Only floating point values are tested.
  */
@@ -49,10 +58,45 @@ public:
 
     /// Return the derivative of this tranform at the value x
     virtual T derivative(T x) const = 0;
+    /**
+     * Return the natural log of the absolute derivative at the value x.
+     *
+     * Transforms with a closed form for this (e.g. -log(x) for a log
+     * transform) should override it to avoid evaluating log(|derivative|).
+     */
+    virtual T log_abs_derivative(T x) const { return std::log(std::abs(this->derivative(x))); }
     /// Return the transformed value of x
     virtual T forward(T x) const = 0;
     /// Return the original value of x given a transformed value
     virtual T reverse(T x) const = 0;
+    /// Return the second derivative of this transform at the value x
+    virtual T second_derivative(T) const {
+        throw std::logic_error(this->str() + " does not implement second_derivative");
+    }
+
+    /// Return the absolute change in a transformed value after reversing and then transforming it
+    T round_trip_error(T x) const { return std::abs(this->forward(this->reverse(x)) - x); }
+
+    /// Write the derivative at each of the n values in x to out
+    virtual void derivative_batch(const T* x, T* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) out[i] = this->derivative(x[i]);
+    }
+    /// Write the log absolute derivative at each of the n values in x to out
+    virtual void log_abs_derivative_batch(const T* x, T* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) out[i] = this->log_abs_derivative(x[i]);
+    }
+    /// Write the transformed value of each of the n values in x to out
+    virtual void forward_batch(const T* x, T* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) out[i] = this->forward(x[i]);
+    }
+    /// Write the original value of each of the n transformed values in x to out
+    virtual void reverse_batch(const T* x, T* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) out[i] = this->reverse(x[i]);
+    }
+    /// Write the second derivative at each of the n values in x to out
+    virtual void second_derivative_batch(const T* x, T* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) out[i] = this->second_derivative(x[i]);
+    }
 
     virtual ~Transform() = default;
 };
@@ -72,8 +116,26 @@ public:
     std::string str() const override { return type_name_str<UnitTransform<T>>(true) + "()"; }
 
     inline T derivative(T) const override { return 1; }
+    inline T log_abs_derivative(T) const override { return 0; }
     inline T forward(T x) const override { return x; }
     inline T reverse(T x) const override { return x; }
+    inline T second_derivative(T) const override { return 0; }
+
+    void derivative_batch(const T*, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = 1;
+    }
+    void log_abs_derivative_batch(const T*, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = 0;
+    }
+    void forward_batch(const T* x, T* out, size_t n) const override {
+        if (out != x) std::copy(x, x + n, out);
+    }
+    void reverse_batch(const T* x, T* out, size_t n) const override {
+        if (out != x) std::copy(x, x + n, out);
+    }
+    void second_derivative_batch(const T*, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = 0;
+    }
 
     ~UnitTransform() = default;
 };
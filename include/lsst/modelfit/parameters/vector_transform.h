@@ -0,0 +1,273 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MODELFIT_PARAMETERS_VECTOR_TRANSFORM_H
+#define LSST_MODELFIT_PARAMETERS_VECTOR_TRANSFORM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "object.h"
+#include "type_name.h"
+
+namespace lsst::modelfit::parameters {
+
+/**
+ * @brief A reversible transformation of a fixed-size group of real values.
+ *
+ * This is the multivariate analogue of Transform, for values that must be
+ * transformed jointly (e.g. fractions that must sum to less than one).
+ * Jacobians are row-major, size() x size() matrices.
+ *
+ * The batch (*_batch) methods evaluate n groups at once, with the values
+ * of each group contiguous, and may be overridden with tighter loops than
+ * the default, which calls the single-group method for each group.
+ *
+ * @tparam T The type of the value. Only floating point values are tested.
+ */
+template <typename T>
+class VectorTransform : public Object {
+public:
+    /// Return a description of this transform
+    virtual std::string description() const = 0;
+    /// Return the number of values transformed jointly
+    virtual size_t size() const = 0;
+
+    /// Write the transformed values of x to y
+    virtual void forward(const T* x, T* y) const = 0;
+    /// Write the Jacobian of the forward transform (dy_i/dx_j) at x to jacobian
+    virtual void jacobian(const T* x, T* jacobian) const = 0;
+    /**
+     * Write the Jacobian of the reverse transform (dx_i/dy_j) at the
+     * transformed values y to jacobian.
+     *
+     * The default implementation inverts the forward Jacobian, which should
+     * be avoided if a closed form is available.
+     */
+    virtual void jacobian_reverse(const T* y, T* jacobian) const {
+        const size_t n = size();
+        std::vector<T> x(n), jac_forward(n * n);
+        this->reverse(y, x.data());
+        this->jacobian(x.data(), jac_forward.data());
+        // Gauss-Jordan elimination with partial pivoting
+        for (size_t row = 0; row < n; ++row) {
+            for (size_t col = 0; col < n; ++col) jacobian[row * n + col] = row == col;
+        }
+        for (size_t col = 0; col < n; ++col) {
+            size_t pivot = col;
+            for (size_t row = col + 1; row < n; ++row) {
+                if (std::abs(jac_forward[row * n + col]) > std::abs(jac_forward[pivot * n + col])) {
+                    pivot = row;
+                }
+            }
+            if (jac_forward[pivot * n + col] == 0) {
+                throw std::runtime_error(this->str() + " has a singular Jacobian");
+            }
+            for (size_t k = 0; k < n; ++k) {
+                std::swap(jac_forward[col * n + k], jac_forward[pivot * n + k]);
+                std::swap(jacobian[col * n + k], jacobian[pivot * n + k]);
+            }
+            const T scale = 1 / jac_forward[col * n + col];
+            for (size_t k = 0; k < n; ++k) {
+                jac_forward[col * n + k] *= scale;
+                jacobian[col * n + k] *= scale;
+            }
+            for (size_t row = 0; row < n; ++row) {
+                const T factor = jac_forward[row * n + col];
+                if ((row == col) || (factor == 0)) continue;
+                for (size_t k = 0; k < n; ++k) {
+                    jac_forward[row * n + k] -= factor * jac_forward[col * n + k];
+                    jacobian[row * n + k] -= factor * jacobian[col * n + k];
+                }
+            }
+        }
+    }
+    /// Return the natural log of the absolute determinant of the forward Jacobian at x
+    virtual T log_abs_det_jacobian(const T* x) const = 0;
+    /// Write the original values of the transformed values y to x
+    virtual void reverse(const T* y, T* x) const = 0;
+
+    /// Write the transformed values of n groups in x to y
+    virtual void forward_batch(const T* x, T* y, size_t n) const {
+        const size_t n_values = size();
+        for (size_t i = 0; i < n; ++i) this->forward(x + i * n_values, y + i * n_values);
+    }
+    /// Write the forward Jacobians of n groups in x to jacobian
+    virtual void jacobian_batch(const T* x, T* jacobian, size_t n) const {
+        const size_t n_values = size();
+        for (size_t i = 0; i < n; ++i) {
+            this->jacobian(x + i * n_values, jacobian + i * n_values * n_values);
+        }
+    }
+    /// Write the log absolute determinants of the forward Jacobians of n groups in x to out
+    virtual void log_abs_det_jacobian_batch(const T* x, T* out, size_t n) const {
+        const size_t n_values = size();
+        for (size_t i = 0; i < n; ++i) out[i] = this->log_abs_det_jacobian(x + i * n_values);
+    }
+    /// Write the original values of n groups of transformed values in y to x
+    virtual void reverse_batch(const T* y, T* x, size_t n) const {
+        const size_t n_values = size();
+        for (size_t i = 0; i < n; ++i) this->reverse(y + i * n_values, x + i * n_values);
+    }
+
+    virtual ~VectorTransform() = default;
+};
+
+/**
+ * @brief A transform of n fractions with a sum less than one to unbounded
+ * values.
+ *
+ * The fractions x_i, along with the implicit remainder r = 1 - sum(x), form
+ * a simplex. The transformed values are the additive log ratios
+ * y_i = log(x_i / r), and the reverse transform is the softmax
+ * x_i = exp(y_i) / (1 + sum(exp(y))).
+ */
+template <typename T>
+class SoftmaxTransform : public VectorTransform<T> {
+private:
+    size_t _size;
+
+    T _get_remainder(const T* x) const {
+        T remainder = 1;
+        for (size_t i = 0; i < _size; ++i) remainder -= x[i];
+        return remainder;
+    }
+
+public:
+    std::string description() const override { return "Softmax (additive log ratio) simplex transform"; }
+    size_t size() const override { return _size; }
+
+    void forward(const T* x, T* y) const override {
+        const T log_remainder = std::log(_get_remainder(x));
+        for (size_t i = 0; i < _size; ++i) y[i] = std::log(x[i]) - log_remainder;
+    }
+    void jacobian(const T* x, T* jacobian) const override {
+        const T inv_remainder = 1 / _get_remainder(x);
+        for (size_t row = 0; row < _size; ++row) {
+            for (size_t col = 0; col < _size; ++col) {
+                jacobian[row * _size + col] = inv_remainder + (row == col ? 1 / x[row] : 0);
+            }
+        }
+    }
+    void jacobian_reverse(const T* y, T* jacobian) const override {
+        // Reverse into the last row, which is overwritten last, to avoid allocating
+        T* x = jacobian + (_size - 1) * _size;
+        this->reverse(y, x);
+        for (size_t row = 0; row + 1 < _size; ++row) {
+            for (size_t col = 0; col < _size; ++col) {
+                jacobian[row * _size + col] = (row == col ? x[row] : 0) - x[row] * x[col];
+            }
+        }
+        const T x_last = x[_size - 1];
+        for (size_t col = 0; col < _size; ++col) x[col] = (col + 1 == _size ? x_last : 0) - x_last * x[col];
+    }
+    // The Jacobian is diag(1/x) + 1/r, with determinant prod(1/x)/r
+    T log_abs_det_jacobian(const T* x) const override {
+        T result = -std::log(_get_remainder(x));
+        for (size_t i = 0; i < _size; ++i) result -= std::log(x[i]);
+        return result;
+    }
+    void reverse(const T* y, T* x) const override {
+        // Subtract the maximum exponent (including the remainder's, 0) for stability
+        T y_max = 0;
+        for (size_t i = 0; i < _size; ++i) y_max = std::max(y_max, y[i]);
+        T sum = std::exp(-y_max);
+        for (size_t i = 0; i < _size; ++i) {
+            x[i] = std::exp(y[i] - y_max);
+            sum += x[i];
+        }
+        for (size_t i = 0; i < _size; ++i) x[i] /= sum;
+    }
+
+    std::string repr(bool name_keywords = false, const std::string_view& namespace_separator
+                                                 = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<SoftmaxTransform<T>>(false, namespace_separator) + "("
+               + (name_keywords ? "size=" : "") + std::to_string(_size) + ")";
+    }
+    std::string str() const override {
+        return type_name_str<SoftmaxTransform<T>>(true) + "(size=" + std::to_string(_size) + ")";
+    }
+
+    /// Initialize a SoftmaxTransform for a given number of fractions
+    explicit SoftmaxTransform(size_t size) : _size(size) {
+        if (size == 0) throw std::invalid_argument("SoftmaxTransform size must be > 0");
+    }
+};
+
+/**
+ * @brief A transform of ellipse parameters (sigma_x, sigma_y, rho) to
+ * unbounded values.
+ *
+ * The transformed values are those of the Cholesky factor L of the
+ * covariance matrix [[sigma_x^2, rho sigma_x sigma_y],
+ * [rho sigma_x sigma_y, sigma_y^2]], with the logarithm of the diagonal
+ * elements: (log(sigma_x), rho sigma_y, log(sigma_y sqrt(1 - rho^2))).
+ * Any transformed values are valid, with sigma_x > 0, sigma_y > 0 and
+ * |rho| < 1.
+ */
+template <typename T>
+class EllipseTransform : public VectorTransform<T> {
+public:
+    std::string description() const override { return "Ellipse (sigma_x, sigma_y, rho) Cholesky transform"; }
+    size_t size() const override { return 3; }
+
+    void forward(const T* x, T* y) const override {
+        y[0] = std::log(x[0]);
+        y[1] = x[2] * x[1];
+        y[2] = std::log(x[1]) + std::log1p(-x[2] * x[2]) / 2;
+    }
+    void jacobian(const T* x, T* jacobian) const override {
+        const T sigma_y = x[1], rho = x[2];
+        const T jac[9] = {1 / x[0], 0, 0, 0, rho, sigma_y, 0, 1 / sigma_y, -rho / (1 - rho * rho)};
+        std::copy(jac, jac + 9, jacobian);
+    }
+    void jacobian_reverse(const T* y, T* jacobian) const override {
+        T x[3];
+        this->reverse(y, x);
+        const T sigma_y = x[1], rho = x[2], one_m_rho2 = 1 - rho * rho;
+        const T jac[9]
+                = {x[0], 0, 0, 0, rho, sigma_y * one_m_rho2, 0, one_m_rho2 / sigma_y, -rho * one_m_rho2};
+        std::copy(jac, jac + 9, jacobian);
+    }
+    T log_abs_det_jacobian(const T* x) const override { return -std::log(x[0]) - std::log1p(-x[2] * x[2]); }
+    void reverse(const T* y, T* x) const override {
+        const T l_22 = std::exp(y[2]);
+        x[0] = std::exp(y[0]);
+        x[1] = std::hypot(y[1], l_22);
+        x[2] = y[1] / x[1];
+    }
+
+    std::string repr(bool = false, const std::string_view& namespace_separator
+                                   = Object::CC_NAMESPACE_SEPARATOR) const override {
+        return type_name_str<EllipseTransform<T>>(false, namespace_separator) + "()";
+    }
+    std::string str() const override { return type_name_str<EllipseTransform<T>>(true) + "()"; }
+};
+
+}  // namespace lsst::modelfit::parameters
+#endif  // LSST_MODELFIT_PARAMETERS_VECTOR_TRANSFORM_H
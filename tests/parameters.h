@@ -29,6 +29,7 @@
 #include <cmath>
 
 #include "lsst/modelfit/parameters/parameter.h"
+#include "lsst/modelfit/parameters/parameter_array.h"
 
 namespace lsst::modelfit::parameters {
 
@@ -61,6 +62,30 @@ struct PositiveParameter : public Parameter<double, PositiveParameter> {
     static inline const std::string _name = "positive";
     using Parameter<double, PositiveParameter>::Parameter;
 };
+
+struct AngleParameter : public Parameter<double, AngleParameter> {
+    static inline constexpr double _min = 0.;
+    static inline constexpr double _max = 360.;
+    static inline constexpr bool _periodic = true;
+    static inline const std::string _desc = "Periodic angle parameter in degrees";
+    static inline const std::string _name = "angle";
+    using Parameter<double, AngleParameter>::Parameter;
+};
+
+struct FluxParameter : public Parameter<double, FluxParameter> {
+    static inline constexpr bool _linear = true;
+    static inline const std::string _desc = "Linear flux parameter";
+    static inline const std::string _name = "flux";
+    using Parameter<double, FluxParameter>::Parameter;
+};
+
+struct PositiveParameterArray : public ParameterArray<double, PositiveParameterArray> {
+    static inline constexpr double _min = DBL_TRUE_MIN;
+    static inline constexpr double _default = 1.;
+    static inline const std::string _desc = "Array of positive, potentially infinite parameters";
+    static inline const std::string _name = "positive_array";
+    using ParameterArray<double, PositiveParameterArray>::ParameterArray;
+};
 }
 
 #endif  // LSST_MODELFIT_PARAMETERS_TESTS_PARAMETERS_H
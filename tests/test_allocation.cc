@@ -0,0 +1,238 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#include "lsst/modelfit/parameters/collection.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+/*
+ * Replacements of the global allocation functions that count allocations.
+ * Any hot-path operation that starts allocating will fail these tests.
+ */
+static size_t n_allocations = 0;
+
+static void* allocate(std::size_t size) {
+    ++n_allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+/// Return the number of allocations made by calling func
+template <typename F>
+size_t count_allocations(F&& func) {
+    const size_t n_before = n_allocations;
+    func();
+    return n_allocations - n_before;
+}
+
+TEST_CASE("count_allocations") {
+    // Check that the replacements are actually in use
+    CHECK_EQ(count_allocations([] { delete new double(1.); }), 1);
+}
+
+TEST_CASE("Parameter getters") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto param = std::make_shared<mod_params::PositiveParameter>(
+            1., nullptr, transform, nullptr, false, "a label long enough to not fit in the SSO buffer");
+    const mod_params::ParameterBase<double>& base = *param;
+    double sum = 0;
+    size_t size = 0;
+    bool free = false;
+    // The first call initializes the static maximal limits
+    sum += base.get_limits_maximal().get_min();
+    CHECK_EQ(count_allocations([&] {
+                 sum += base.get_default() + base.get_min() + base.get_max() + base.get_value()
+                        + base.get_value_transformed() + base.get_transform_derivative();
+                 sum += base.get_limits().get_min() + base.get_limits_maximal().get_max();
+                 sum += base.get_transform().forward(2.);
+                 size += base.get_desc().size() + base.get_label().size() + base.get_name().size();
+                 free = base.get_free() && !base.get_fixed() && !base.get_linear();
+             }),
+             0);
+    CHECK_GT(size, 0);
+    CHECK_EQ(free, true);
+}
+
+TEST_CASE("Parameter setters") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<mod_params::Limits<double>>(1e-3, 1e3);
+    auto param = std::make_shared<mod_params::PositiveParameter>(1., limits, transform);
+    mod_params::ParameterBase<double>& base = *param;
+    // The first value set may allocate value statistics, if enabled
+    base.set_value(1.);
+    CHECK_EQ(count_allocations([&] {
+                 base.set_value(2.);
+                 base.set_value_transformed(0.);
+                 base.set_fixed(true);
+                 base.set_free(true);
+             }),
+             0);
+    CHECK_EQ(base.get_value(), 1.);
+}
+
+TEST_CASE("Transform batches") {
+    const mod_params::Transform<double>& transform = mod_params::LogTransform<double>();
+    const mod_params::Transform<double>& unit = mod_params::UnitTransform<double>::get();
+    double values[4] = {0.5, 1., 2., 4.};
+    double out[4];
+    CHECK_EQ(count_allocations([&] {
+                 for (const auto* trans : {&transform, &unit}) {
+                     trans->forward_batch(values, out, 4);
+                     trans->reverse_batch(out, out, 4);
+                     trans->derivative_batch(values, out, 4);
+                     trans->second_derivative_batch(values, out, 4);
+                     trans->log_abs_derivative_batch(values, out, 4);
+                 }
+             }),
+             0);
+}
+
+TEST_CASE("ParameterCollection gather/scatter") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto collection = mod_params::ParameterCollection<double>();
+    for (size_t i = 0; i < 16; ++i) {
+        collection.add(std::make_shared<mod_params::PositiveParameter>(1. + i, nullptr, transform));
+        collection.add(std::make_shared<mod_params::RealParameter>(i, nullptr, nullptr, nullptr, i % 2));
+    }
+    const size_t n_free = collection.get_n_free();
+    std::vector<double> values(n_free);
+    std::vector<double> gradient(n_free, 1.);
+    std::vector<double> hessian(n_free * n_free, 1.);
+    std::vector<double> direction(n_free, 0.);
+    std::vector<bool> at_limits(n_free);
+    double log_det = 0;
+    collection.get_values(values);
+    collection.set_values(values);
+    const std::vector<double> alphas = {0., 0.5, 1.};
+    mod_params::ParameterCollection<double>::StepCandidates candidates;
+    // The first step caches plans and sizes buffers
+    collection.apply_step(direction, 0., mod_params::LimitPolicy::error, at_limits);
+    collection.evaluate_steps(direction, alphas, candidates);
+    CHECK_EQ(count_allocations([&] {
+                 collection.get_values_transformed(values);
+                 collection.set_values_transformed(values);
+                 collection.get_values(values);
+                 collection.set_values(values);
+                 collection.apply_step(direction, 0.1, mod_params::LimitPolicy::error, at_limits);
+                 collection.evaluate_steps(direction, alphas, candidates);
+                 collection.transform_hessian(hessian, gradient);
+                 collection.transform_hessian_diagonal(values, gradient);
+                 collection.transform_gradient(gradient);
+                 log_det = collection.log_abs_det_jacobian();
+             }),
+             0);
+    CHECK_LT(log_det, 0);
+}
+
+TEST_CASE("ParameterCollection linear partition") {
+    auto collection = mod_params::ParameterCollection<double>();
+    for (size_t i = 0; i < 8; ++i) {
+        collection.add(std::make_shared<mod_params::FluxParameter>(1. + i));
+        collection.add(std::make_shared<mod_params::RealParameter>(i));
+    }
+    auto other = std::make_shared<mod_params::RealParameter>(0.);
+    std::vector<double> values(8);
+    // The first calls cache the partition (and may allocate value statistics, if enabled)
+    collection.get_values_linear(values);
+    collection.set_values_linear(values);
+    // Changing parameters outside the collection must not rebuild it
+    CHECK_EQ(count_allocations([&] {
+                 other->set_fixed(!other->get_fixed());
+                 collection.get_values_linear(values);
+                 collection.set_values_linear(values);
+             }),
+             0);
+    CHECK_EQ(values[7], 8.);
+}
+
+TEST_CASE("ParameterCollection vector transform groups") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto collection = mod_params::ParameterCollection<double>();
+    collection.add(std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform));
+    std::vector<std::shared_ptr<mod_params::ParameterBase<double>>> ellipse = {
+            std::make_shared<mod_params::PositiveParameter>(1.5),
+            std::make_shared<mod_params::PositiveParameter>(0.4),
+            std::make_shared<mod_params::RealParameter>(0.3),
+    };
+    std::vector<std::shared_ptr<mod_params::ParameterBase<double>>> fractions = {
+            std::make_shared<mod_params::RealParameter>(0.2),
+            std::make_shared<mod_params::RealParameter>(0.3),
+    };
+    for (const auto& parameter : ellipse) collection.add(parameter);
+    for (const auto& parameter : fractions) collection.add(parameter);
+    collection.add_vector_transform(std::make_shared<const mod_params::EllipseTransform<double>>(), ellipse);
+    collection.add_vector_transform(std::make_shared<const mod_params::SoftmaxTransform<double>>(2),
+                                    fractions);
+
+    const size_t n_free = collection.get_n_free();
+    std::vector<double> values(n_free), errors(n_free), gradient(n_free, 1.), direction(n_free, 0.1);
+    const std::vector<double> alphas = {0., 0.5, 1.};
+    mod_params::ParameterCollection<double>::StepCandidates candidates;
+    double log_det = 0;
+    // The first calls cache indices and size buffers (and may allocate value statistics, if enabled)
+    collection.get_values_transformed(values);
+    collection.set_values_transformed(values);
+    collection.evaluate_steps(direction, alphas, candidates);
+    CHECK_EQ(count_allocations([&] {
+                 collection.get_values_transformed(values);
+                 collection.set_values_transformed(values);
+                 collection.get_round_trip_errors(errors);
+                 collection.transform_gradient(gradient);
+                 log_det = collection.log_abs_det_jacobian();
+                 collection.evaluate_steps(direction, alphas, candidates);
+             }),
+             0);
+    CHECK_EQ(values[0], doctest::Approx(std::log(2.)));
+    CHECK_NE(log_det, 0);
+
+    // Each free parameter's values for every set are contiguous
+    const size_t n_sets = 4;
+    std::vector<double> values_sets(n_free * n_sets), log_dets(n_sets);
+    collection.get_values(values);
+    for (size_t idx = 0; idx < n_free; ++idx) {
+        std::fill_n(values_sets.begin() + idx * n_sets, n_sets, values[idx]);
+    }
+    collection.log_abs_det_jacobian(values_sets, log_dets);
+    CHECK_EQ(count_allocations([&] { collection.log_abs_det_jacobian(values_sets, log_dets); }), 0);
+    CHECK_EQ(log_dets[n_sets - 1], doctest::Approx(log_det));
+}
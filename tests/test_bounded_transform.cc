@@ -0,0 +1,166 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "lsst/modelfit/parameters/bounded_transform.h"
+#include "lsst/modelfit/parameters/collection.h"
+
+#include "parameters.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+namespace {
+void check_transform(const mod_params::BoundedTransform<double>& transform,
+                     const std::vector<double>& values) {
+    const double step = 1e-6;
+    for (double x : values) {
+        const double y = transform.forward(x);
+        CHECK_EQ(transform.reverse(y), doctest::Approx(x));
+        const double deriv = transform.derivative(x);
+        const double deriv_numeric = (transform.forward(x + step) - transform.forward(x - step)) / (2 * step);
+        CHECK_EQ(deriv, doctest::Approx(deriv_numeric).epsilon(1e-5));
+        CHECK_EQ(transform.log_abs_derivative(x), doctest::Approx(std::log(std::abs(deriv))));
+        const double deriv2_numeric
+                = (transform.derivative(x + step) - transform.derivative(x - step)) / (2 * step);
+        CHECK_EQ(transform.second_derivative(x), doctest::Approx(deriv2_numeric).epsilon(1e-5));
+    }
+    const size_t n_values = values.size();
+    std::vector<double> forward(n_values), reverse(n_values), deriv(n_values), log_deriv(n_values),
+            deriv2(n_values);
+    transform.forward_batch(values.data(), forward.data(), n_values);
+    transform.reverse_batch(forward.data(), reverse.data(), n_values);
+    transform.derivative_batch(values.data(), deriv.data(), n_values);
+    transform.log_abs_derivative_batch(values.data(), log_deriv.data(), n_values);
+    transform.second_derivative_batch(values.data(), deriv2.data(), n_values);
+    for (size_t i = 0; i < n_values; ++i) {
+        CHECK_EQ(forward[i], transform.forward(values[i]));
+        CHECK_EQ(reverse[i], transform.reverse(forward[i]));
+        CHECK_EQ(deriv[i], transform.derivative(values[i]));
+        CHECK_EQ(log_deriv[i], transform.log_abs_derivative(values[i]));
+        CHECK_EQ(deriv2[i], transform.second_derivative(values[i]));
+    }
+    // Any transformed value must be valid
+    const mod_params::Limits<double> limits(transform.get_min(), transform.get_max());
+    for (double y : {-1e300, -800., -40., 0., 40., 800., 1e300}) CHECK(limits.check(transform.reverse(y)));
+}
+}  // namespace
+
+TEST_CASE("BoundedTransform") {
+    double inf = std::numeric_limits<double>::infinity();
+    using Kind = mod_params::BoundedTransform<double>::Kind;
+
+    const mod_params::BoundedTransform<double> both(mod_params::Limits<double>(-1., 3.));
+    CHECK_EQ(both.get_kind(), Kind::both);
+    CHECK_EQ(both.forward(1.), doctest::Approx(0.));
+    CHECK_EQ(both.forward(-1.), -inf);
+    check_transform(both, {-0.99, 0., 1., 2.5, 2.99});
+
+    const mod_params::BoundedTransform<double> lower(mod_params::Limits<double>(2., inf));
+    CHECK_EQ(lower.get_kind(), Kind::lower);
+    CHECK_EQ(lower.forward(2. + log(2.)), doctest::Approx(0.));
+    // Large values are nearly unchanged, without overflow
+    CHECK_EQ(lower.forward(1002.), doctest::Approx(1000.));
+    check_transform(lower, {2.01, 2.5, 10., 100.});
+
+    const mod_params::BoundedTransform<double> upper(mod_params::Limits<double>(-inf, 0.));
+    CHECK_EQ(upper.get_kind(), Kind::upper);
+    CHECK_EQ(upper.forward(-log(2.)), doctest::Approx(0.));
+    check_transform(upper, {-50., -1., -0.01});
+
+    const mod_params::BoundedTransform<double> unbounded{mod_params::Limits<double>()};
+    CHECK_EQ(unbounded.get_kind(), Kind::unbounded);
+    CHECK_EQ(unbounded.forward(-5.), -5.);
+    check_transform(unbounded, {-5., 0., 5.});
+
+    CHECK_THROWS_AS(mod_params::BoundedTransform<double>(mod_params::Limits<double>(1., 1.)),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(mod_params::BoundedTransform<double>(mod_params::Limits<double>(0., 1., "", true)),
+                    std::invalid_argument);
+    CHECK_GT(both.repr().size(), 0);
+    CHECK_GT(both.str().size(), 0);
+}
+
+TEST_CASE("make_bounded_transform") {
+    double inf = std::numeric_limits<double>::infinity();
+    using Kind = mod_params::BoundedTransform<double>::Kind;
+
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2.);
+    auto transform = mod_params::make_bounded_transform(*pos);
+    CHECK_EQ(transform->get_kind(), Kind::lower);
+    CHECK_EQ(transform->get_min(), DBL_TRUE_MIN);
+    pos->set_limits(std::make_shared<const mod_params::Limits<double>>(1., 4.));
+    CHECK_EQ(mod_params::make_bounded_transform(*pos)->get_kind(), Kind::both);
+
+    auto real = std::make_shared<mod_params::RealParameter>(-2.);
+    CHECK_EQ(mod_params::make_bounded_transform(*real)->get_kind(), Kind::unbounded);
+    real->set_limits(std::make_shared<const mod_params::Limits<double>>(-inf, 0.));
+    CHECK_EQ(mod_params::make_bounded_transform(*real)->get_kind(), Kind::upper);
+    auto angle = mod_params::AngleParameter(10.);
+    CHECK_EQ(mod_params::make_bounded_transform(angle)->get_kind(), Kind::unbounded);
+
+    // Collections can reparameterize all free parameters at once
+    auto collection = mod_params::ParameterCollection<double>({pos, real});
+    collection.set_transforms_bounded();
+    std::vector<double> values(2);
+    collection.get_values_transformed(values);
+    CHECK_EQ(values[0], doctest::Approx(-log(2.)));
+    // Every transformed value is valid
+    collection.set_values_transformed({1e6, -1e6});
+    CHECK_EQ(pos->get_value(), 4.);
+    CHECK_LE(real->get_value(), 0.);
+    collection.set_values_transformed({-1e6, 1e6});
+    CHECK_EQ(pos->get_value(), 1.);
+    CHECK_EQ(real->get_value(), 0.);
+}
+
+TEST_CASE("ParameterCollection set_transforms_bounded at limits") {
+    auto limits = std::make_shared<const mod_params::Limits<double>>(1., 4.);
+    auto at_min = std::make_shared<mod_params::RealParameter>(1., limits);
+    auto at_max = std::make_shared<mod_params::RealParameter>(4., limits);
+    auto upper = std::make_shared<mod_params::RealParameter>(
+            0., std::make_shared<const mod_params::Limits<double>>(-INFINITY, 0.));
+    auto collection = mod_params::ParameterCollection<double>({at_min, at_max, upper});
+    collection.set_transforms_bounded();
+
+    // Values on a bound are moved inward so that transformed values are finite
+    const double nudge = std::sqrt(std::numeric_limits<double>::epsilon());
+    CHECK_EQ(at_min->get_value(), doctest::Approx(1. + 3. * nudge));
+    CHECK_EQ(at_max->get_value(), doctest::Approx(4. - 3. * nudge));
+    CHECK_EQ(upper->get_value(), doctest::Approx(-nudge));
+    std::vector<double> values(3);
+    collection.get_values_transformed(values);
+    for (double value : values) CHECK(std::isfinite(value));
+    collection.apply_step({1., -1., 1.}, 1.);
+    collection.get_values(values);
+    for (double value : values) CHECK(std::isfinite(value));
+    CHECK_LT(upper->get_value(), 0.);
+}
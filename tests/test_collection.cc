@@ -0,0 +1,363 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include "lsst/modelfit/parameters/collection.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ParameterCollection") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto real = std::make_shared<mod_params::RealParameter>(3.);
+    auto fixed = std::make_shared<mod_params::RealParameter>(-1., nullptr, nullptr, nullptr, true);
+
+    auto collection = mod_params::ParameterCollection<double>({pos, fixed, real});
+    CHECK_EQ(collection.size(), 3);
+    CHECK_EQ(collection.get_n_free(), 2);
+    CHECK_EQ(collection.at(1), *fixed);
+    CHECK_GT(collection.repr().size(), 0);
+    CHECK_GT(collection.str().size(), 0);
+    CHECK_THROWS(collection.add(nullptr));
+
+    std::vector<double> values(2);
+    collection.get_values_transformed(values);
+    CHECK_EQ(values[0], doctest::Approx(log(2.)));
+    CHECK_EQ(values[1], 3.);
+    values[0] = 0.;
+    collection.set_values_transformed(values);
+    CHECK_EQ(pos->get_value(), doctest::Approx(1.));
+    collection.set_values({2., 3.});
+    CHECK_EQ(pos->get_value(), 2.);
+    std::vector<double> values_wrong(3);
+    CHECK_THROWS(collection.get_values(values_wrong));
+
+    // L(x0, x1) = x0^2 x1, with x0 log-transformed
+    const double x0 = 2., x1 = 3.;
+    std::vector<double> gradient = {2 * x0 * x1, x0 * x0};
+    std::vector<double> hessian = {2 * x1, 2 * x0, 2 * x0, 0};
+    std::vector<double> diagonal = {hessian[0], hessian[3]};
+    collection.transform_hessian(hessian, gradient);
+    collection.transform_hessian_diagonal(diagonal, gradient);
+    CHECK_EQ(hessian[0], doctest::Approx(4 * x0 * x0 * x1));
+    CHECK_EQ(hessian[1], doctest::Approx(2 * x0 * x0));
+    CHECK_EQ(hessian[2], doctest::Approx(2 * x0 * x0));
+    CHECK_EQ(hessian[3], 0);
+    CHECK_EQ(diagonal[0], doctest::Approx(hessian[0]));
+    CHECK_EQ(diagonal[1], hessian[3]);
+    CHECK_EQ(collection.log_abs_det_jacobian(), doctest::Approx(-log(x0)));
+    // Values for two sets, with each parameter's values contiguous
+    std::vector<double> sets = {1., 4., 0., -2.};
+    std::vector<double> log_dets(2);
+    collection.log_abs_det_jacobian(sets, log_dets);
+    CHECK_EQ(log_dets[0], 0);
+    CHECK_EQ(log_dets[1], doctest::Approx(-log(4.)));
+
+    collection.transform_gradient(gradient);
+    CHECK_EQ(gradient[0], doctest::Approx(2 * x0 * x0 * x1));
+    CHECK_EQ(gradient[1], x0 * x0);
+}
+
+TEST_CASE("ParameterCollection ties") {
+    auto cen_g = std::make_shared<mod_params::RealParameter>(1.);
+    auto cen_r = std::make_shared<mod_params::RealParameter>(0.);
+    auto cen_i = std::make_shared<mod_params::RealParameter>(0.);
+    auto size = std::make_shared<mod_params::PositiveParameter>(2.);
+    auto collection = mod_params::ParameterCollection<double>({cen_g, cen_r, cen_i, size});
+    CHECK_EQ(collection.get_n_free(), 4);
+
+    collection.tie(cen_r, *cen_g);
+    collection.tie(cen_i, *cen_g, 2., 0.5);
+    CHECK_EQ(collection.get_ties().size(), 2);
+    CHECK_EQ(collection.get_n_free(), 2);
+    CHECK_EQ(cen_r->get_value(), 1.);
+    CHECK_EQ(cen_i->get_value(), 2.5);
+
+    CHECK_THROWS(collection.tie(cen_r, *cen_g));
+    CHECK_THROWS(collection.tie(cen_g, *size));
+    CHECK_THROWS(collection.tie(size, *cen_r));
+    CHECK_THROWS(collection.tie(size, *size));
+    CHECK_THROWS(collection.tie(size, mod_params::RealParameter()));
+
+    collection.set_values({3., 4.});
+    CHECK_EQ(cen_r->get_value(), 3.);
+    CHECK_EQ(cen_i->get_value(), 6.5);
+    CHECK_EQ(size->get_value(), 4.);
+
+    collection.untie(*cen_r);
+    CHECK_EQ(collection.get_n_free(), 3);
+    std::vector<double> values(3);
+    collection.get_values(values);
+    CHECK_EQ(values, std::vector<double>{3., 3., 4.});
+}
+
+TEST_CASE("ParameterCollection ties LimitPolicy") {
+    auto source = std::make_shared<mod_params::RealParameter>(0.5);
+    auto tied = std::make_shared<mod_params::RealParameter>(
+            0.5, std::make_shared<const mod_params::Limits<double>>(0., 1.));
+    auto collection = mod_params::ParameterCollection<double>({source, tied});
+    collection.tie(tied, *source);
+
+    // Tied parameters with narrower limits than their sources follow the policy
+    CHECK_THROWS_AS(collection.set_values({2.}), std::runtime_error);
+    collection.set_limit_policy(mod_params::LimitPolicy::penalize);
+    CHECK_EQ(collection.set_values({2.}), 1.);
+    CHECK_EQ(tied->get_value(), 1.);
+    CHECK_EQ(collection.set_values_transformed({-1.}), 1.);
+    CHECK_EQ(tied->get_value(), 0.);
+    CHECK_EQ(collection.apply_step({3.}, 1.), 1.);
+    CHECK_EQ(tied->get_value(), 1.);
+    collection.set_limit_policy(mod_params::LimitPolicy::clip);
+    CHECK_EQ(collection.update_ties(), 0.);
+    CHECK_EQ(collection.set_values({-3.}), 0.);
+    CHECK_EQ(tied->get_value(), 0.);
+}
+
+TEST_CASE("ParameterCollection LimitPolicy") {
+    auto limits = std::make_shared<const mod_params::Limits<double>>(0., 1.);
+    auto real = std::make_shared<mod_params::RealParameter>(0.5, limits);
+    auto real2 = std::make_shared<mod_params::RealParameter>(0.5, limits);
+    auto collection = mod_params::ParameterCollection<double>({real, real2});
+    CHECK_EQ(collection.get_limit_policy(), mod_params::LimitPolicy::error);
+    CHECK_THROWS(collection.set_values({2., 0.5}));
+
+    CHECK_EQ(collection.set_values({2., -1.}, mod_params::LimitPolicy::penalize), doctest::Approx(2.));
+    CHECK_EQ(real->get_value(), 1.);
+    CHECK_EQ(real2->get_value(), 0.);
+
+    collection.set_limit_policy(mod_params::LimitPolicy::reflect);
+    CHECK_EQ(collection.set_values_transformed({1.25, -0.25}), 0.);
+    CHECK_EQ(real->get_value(), doctest::Approx(0.75));
+    CHECK_EQ(real2->get_value(), doctest::Approx(0.25));
+}
+
+TEST_CASE("ParameterCollection get_limits_transformed") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<const mod_params::Limits<double>>(1., 10.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., limits, transform_log);
+    auto fixed = std::make_shared<mod_params::RealParameter>(-1., nullptr, nullptr, nullptr, true);
+    auto real = std::make_shared<mod_params::RealParameter>(0.5, limits);
+    auto collection = mod_params::ParameterCollection<double>({pos, fixed, real});
+
+    std::vector<double> lower(2), upper(2);
+    collection.get_limits_transformed(lower, upper);
+    CHECK_EQ(lower[0], 0.);
+    CHECK_EQ(upper[0], doctest::Approx(log(10.)));
+    CHECK_EQ(lower[1], 1.);
+    CHECK_EQ(upper[1], 10.);
+    std::vector<double> wrong(3);
+    CHECK_THROWS(collection.get_limits_transformed(wrong, upper));
+}
+
+TEST_CASE("ParameterCollection apply_step") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<const mod_params::Limits<double>>(0.5, 4.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(1., limits, transform_log);
+    auto real = std::make_shared<mod_params::RealParameter>(0., limits);
+    auto fixed = std::make_shared<mod_params::RealParameter>(-1., nullptr, nullptr, nullptr, true);
+    auto collection = mod_params::ParameterCollection<double>({pos, fixed, real});
+
+    std::vector<bool> at_limits(2);
+    CHECK_THROWS(collection.apply_step({1., 1., 1.}, 1., mod_params::LimitPolicy::clip, at_limits));
+    // real starts beyond its limits, so the step must move it within them
+    CHECK_EQ(collection.apply_step({1., 1.}, 0.5, mod_params::LimitPolicy::error, at_limits), 0.);
+    CHECK_EQ(at_limits, std::vector<bool>{false, false});
+    CHECK_EQ(pos->get_value_transformed(), 0.5);
+    CHECK_EQ(pos->get_value(), doctest::Approx(exp(0.5)));
+    CHECK_EQ(real->get_value(), 0.5);
+    CHECK_EQ(fixed->get_value(), -1.);
+
+    // Values are checked before any are set, so a failed step changes nothing
+    CHECK_THROWS_AS(collection.apply_step({-1., 10.}, 2., mod_params::LimitPolicy::error, at_limits),
+                    std::runtime_error);
+    CHECK_EQ(pos->get_value_transformed(), 0.5);
+    CHECK_EQ(real->get_value(), 0.5);
+    CHECK_THROWS(collection.apply_step({1., 0.}, 2., mod_params::LimitPolicy::error, at_limits));
+    collection.apply_step({-1., 0.}, 0.5, mod_params::LimitPolicy::error, at_limits);
+
+    CHECK_EQ(collection.apply_step({1., -1.}, 2., mod_params::LimitPolicy::penalize, at_limits),
+             doctest::Approx((exp(2.) - 4.) * (exp(2.) - 4.) + 4.));
+    CHECK_EQ(at_limits, std::vector<bool>{true, true});
+    CHECK_EQ(pos->get_value(), 4.);
+    CHECK_EQ(pos->get_value_transformed(), doctest::Approx(log(4.)));
+    CHECK_EQ(real->get_value(), 0.5);
+
+    collection.set_limit_policy(mod_params::LimitPolicy::clip);
+    CHECK_EQ(collection.apply_step({-0.1, 1.}, 1.), 0.);
+    CHECK_EQ(pos->get_value(), doctest::Approx(4. * exp(-0.1)));
+    CHECK_EQ(real->get_value(), 1.5);
+}
+
+TEST_CASE("ParameterCollection apply_step ties and batches") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 1., nullptr, transform_log);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto real = std::make_shared<mod_params::RealParameter>(0.);
+    auto tied = std::make_shared<mod_params::RealParameter>(
+            0., std::make_shared<const mod_params::Limits<double>>(-1., 1.));
+    auto collection = mod_params::ParameterCollection<double>(
+            {array->get_element(0), real, pos, array->get_element(1), tied, array->get_element(2)});
+    collection.tie(tied, *real);
+
+    // The array elements and pos share a transform, so they're reversed in one batch
+    const std::vector<double> direction = {0.5, 0.25, -0.5, 1., 0.};
+    std::vector<bool> at_limits(5);
+    CHECK_EQ(collection.apply_step(direction, 1., mod_params::LimitPolicy::error, at_limits), 0.);
+    CHECK_EQ(array->get_value(0), doctest::Approx(exp(0.5)));
+    CHECK_EQ(pos->get_value(), doctest::Approx(2. * exp(-0.5)));
+    CHECK_EQ(array->get_value(1), doctest::Approx(exp(1.)));
+    CHECK_EQ(array->get_value(2), 1.);
+    CHECK_EQ(tied->get_value(), 0.25);
+
+    // A tied value beyond its limits fails the step before any values are set
+    std::vector<double> values(5), values_new(5);
+    collection.get_values(values);
+    CHECK_THROWS_AS(collection.apply_step(direction, 4., mod_params::LimitPolicy::error, at_limits),
+                    std::runtime_error);
+    collection.get_values(values_new);
+    CHECK_EQ(values_new, values);
+    CHECK_EQ(tied->get_value(), 0.25);
+}
+
+TEST_CASE("ParameterCollection apply_step set_transformed_exact") {
+    auto quantized = std::make_shared<mod_params::QuantizedTransform<double>>();
+    auto real = std::make_shared<mod_params::RealParameter>(0., nullptr, quantized);
+    auto collection = mod_params::ParameterCollection<double>({real});
+
+    // The stepped transformed value is only stored if exact
+    collection.apply_step({0.3}, 1.);
+    CHECK_EQ(real->get_value(), 0.3);
+    CHECK_EQ(real->get_value_transformed(), 0.25);
+    real->set_transformed_exact(true);
+    collection.apply_step({0.4}, 1.);
+    CHECK_EQ(real->get_value(), doctest::Approx(0.65));
+    CHECK_EQ(real->get_value_transformed(), doctest::Approx(0.65));
+}
+
+TEST_CASE("ParameterCollection evaluate_steps") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<const mod_params::Limits<double>>(0.5, 4.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(1., limits, transform_log);
+    auto real = std::make_shared<mod_params::RealParameter>(1., limits);
+    auto angle = std::make_shared<mod_params::AngleParameter>(350.);
+    auto collection = mod_params::ParameterCollection<double>({pos, real, angle});
+
+    const std::vector<double> direction = {1., -1., 20.};
+    const std::vector<double> alphas = {0., 0.25, 1.};
+    mod_params::ParameterCollection<double>::StepCandidates candidates;
+    const auto version = pos->get_version();
+    collection.evaluate_steps(direction, alphas, candidates);
+    CHECK_EQ(pos->get_version(), version);
+    CHECK_EQ(pos->get_value(), 1.);
+    CHECK_EQ(candidates.size(), 3);
+    CHECK_EQ(candidates.values.size(), 9);
+
+    CHECK_EQ(candidates.values[0], 1.);
+    CHECK_EQ(candidates.values[3], doctest::Approx(exp(0.25)));
+    CHECK_EQ(candidates.values[4], 0.75);
+    CHECK_EQ(candidates.values[5], 355.);
+    CHECK_EQ(candidates.values[6], doctest::Approx(exp(1.)));
+    CHECK_EQ(candidates.values[7], 0.);
+    // The angle wraps around
+    CHECK_EQ(candidates.values[8], doctest::Approx(10.));
+    CHECK_EQ(candidates.values_transformed[8], doctest::Approx(10.));
+    CHECK_EQ(candidates.get_feasible(0), true);
+    CHECK_EQ(candidates.get_feasible(1), true);
+    CHECK_EQ(candidates.get_feasible(2), false);
+    CHECK_EQ(candidates.feasible[6], true);
+    CHECK_EQ(candidates.feasible[7], false);
+
+    CHECK_THROWS(collection.commit_step(candidates, 3, mod_params::LimitPolicy::error));
+    CHECK_THROWS(collection.commit_step(candidates, 2, mod_params::LimitPolicy::error));
+    collection.commit_step(candidates, 1, mod_params::LimitPolicy::error);
+    CHECK_EQ(pos->get_value(), doctest::Approx(exp(0.25)));
+    CHECK_EQ(pos->get_value_transformed(), doctest::Approx(0.25));
+    CHECK_EQ(real->get_value(), 0.75);
+    CHECK_EQ(angle->get_value(), 355.);
+
+    collection.evaluate_steps(direction, {1.}, candidates);
+    const double penalty = collection.commit_step(candidates, 0, mod_params::LimitPolicy::penalize);
+    CHECK_EQ(penalty, doctest::Approx(0.5625));
+    CHECK_EQ(real->get_value(), 0.5);
+    CHECK_EQ(angle->get_value(), doctest::Approx(15.));
+
+    candidates.n_free = 2;
+    CHECK_THROWS(collection.commit_step(candidates, 0, mod_params::LimitPolicy::error));
+}
+
+TEST_CASE("ParameterCollection get_round_trip_errors") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(3., nullptr, transform_log);
+    auto real = std::make_shared<mod_params::RealParameter>(1.5);
+    auto collection = mod_params::ParameterCollection<double>({pos, real});
+    std::vector<double> errors(2);
+    collection.get_round_trip_errors(errors);
+    CHECK_LT(errors[0], 1e-15);
+    CHECK_EQ(errors[1], 0.);
+}
+
+TEST_CASE("ParameterCollection linear partition") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto flux1 = std::make_shared<mod_params::FluxParameter>(1.);
+    auto size = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto flux2 = std::make_shared<mod_params::FluxParameter>(3.);
+    auto flux_fixed = std::make_shared<mod_params::FluxParameter>(4., nullptr, nullptr, nullptr, true);
+    auto flux_tied = std::make_shared<mod_params::FluxParameter>(0.);
+    auto cen = std::make_shared<mod_params::RealParameter>(5.);
+    auto collection = mod_params::ParameterCollection<double>(
+            {flux1, size, flux_fixed, flux2, flux_tied, cen});
+    collection.tie(flux_tied, *flux2, 0.5);
+
+    const auto& partition = collection.get_linear_partition();
+    CHECK_EQ(partition.indices_linear, std::vector<size_t>{0, 3});
+    CHECK_EQ(partition.indices_nonlinear, std::vector<size_t>{1, 5});
+    CHECK_EQ(partition.indices_free_linear, std::vector<size_t>{0, 2});
+    CHECK_EQ(partition.indices_free_nonlinear, std::vector<size_t>{1, 3});
+
+    std::vector<double> values(2);
+    collection.get_values_linear(values);
+    CHECK_EQ(values, std::vector<double>{1., 3.});
+    collection.get_values_nonlinear_transformed(values);
+    CHECK_EQ(values, std::vector<double>{log(2.), 5.});
+
+    CHECK_EQ(collection.set_values_linear({6., 8.}), 0.);
+    CHECK_EQ(flux2->get_value(), 8.);
+    CHECK_EQ(flux_tied->get_value(), 4.);
+    collection.set_values_nonlinear_transformed({0., -1.});
+    CHECK_EQ(size->get_value(), 1.);
+    CHECK_EQ(cen->get_value(), -1.);
+    CHECK_THROWS_AS(collection.set_values_linear({1.}), std::invalid_argument);
+
+    // The partition is recomputed when free status changes
+    flux_fixed->set_free(true);
+    CHECK_EQ(collection.get_linear_partition().indices_linear, std::vector<size_t>{0, 2, 3});
+    collection.untie(*flux_tied);
+    CHECK_EQ(collection.get_linear_partition().indices_free_linear, std::vector<size_t>{0, 2, 3, 4});
+}
@@ -0,0 +1,125 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <cmath>
+
+#include "lsst/modelfit/parameters/derived.h"
+
+#include "parameters.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("DerivedParameter") {
+    auto flux_g = std::make_shared<mod_params::RealParameter>(2.);
+    auto flux_r = std::make_shared<mod_params::RealParameter>(3.);
+    size_t n_calls = 0;
+    auto flux_total = mod_params::DerivedParameter<double>(
+            {flux_g, flux_r},
+            [&n_calls](const std::vector<double>& values) {
+                ++n_calls;
+                return values[0] + values[1];
+            },
+            nullptr, "total");
+    CHECK_EQ(flux_total.get_stale(), true);
+    CHECK_EQ(flux_total.get_value(), 5.);
+    CHECK_EQ(flux_total.get_value(), 5.);
+    CHECK_EQ(n_calls, 1);
+    CHECK_EQ(flux_total.get_stale(), false);
+
+    flux_g->set_value(4.);
+    CHECK_EQ(flux_total.get_stale(), true);
+    CHECK_EQ(flux_total.get_value(), 7.);
+    CHECK_EQ(n_calls, 2);
+    const auto& derivs = flux_total.get_derivatives();
+    CHECK_EQ(derivs[0], doctest::Approx(1.));
+    CHECK_EQ(derivs[1], doctest::Approx(1.));
+    const size_t n_calls_derivs = n_calls;
+    flux_total.get_derivatives();
+    CHECK_EQ(n_calls, n_calls_derivs);
+    flux_total.invalidate();
+    flux_total.get_value();
+    CHECK_EQ(n_calls, n_calls_derivs + 1);
+
+    CHECK_GT(flux_total.repr().size(), 0);
+    CHECK_GT(flux_total.str().size(), 0);
+    CHECK_EQ(flux_total.get_label(), "total");
+    CHECK_EQ(flux_total.get_inputs().size(), 2);
+}
+
+TEST_CASE("DerivedParameter gradient") {
+    auto x = std::make_shared<mod_params::RealParameter>(2.);
+    auto y = std::make_shared<mod_params::RealParameter>(3.);
+    auto product = mod_params::DerivedParameter<double>(
+            {x, y}, [](const std::vector<double>& values) { return values[0] * values[1]; },
+            [](const std::vector<double>& values, std::vector<double>& derivatives) {
+                derivatives[0] = values[1];
+                derivatives[1] = values[0];
+            });
+    CHECK_EQ(product.get_value(), 6.);
+    y->set_value(5.);
+    CHECK_EQ(product.get_derivatives()[0], 5.);
+    CHECK_EQ(product.get_value(), 10.);
+    CHECK_THROWS(mod_params::DerivedParameter<double>({x}, nullptr));
+    CHECK_THROWS(mod_params::DerivedParameter<double>(
+            {nullptr}, [](const std::vector<double>& values) { return values[0]; }));
+}
+
+TEST_CASE("DerivedParameter chained") {
+    auto flux_g = std::make_shared<mod_params::RealParameter>(10.);
+    auto flux_r = std::make_shared<mod_params::RealParameter>(100.);
+    auto to_mag = [](const std::vector<double>& values) { return -2.5 * std::log10(values[0]); };
+    auto mag_g = std::make_shared<const mod_params::DerivedParameter<double>>(
+            mod_params::DerivedParameter<double>::Inputs{flux_g}, to_mag, nullptr, "mag_g");
+    auto mag_r = std::make_shared<const mod_params::DerivedParameter<double>>(
+            mod_params::DerivedParameter<double>::Inputs{flux_r}, to_mag, nullptr, "mag_r");
+    size_t n_calls = 0;
+    auto colour = mod_params::DerivedParameter<double>(
+            {},
+            [&n_calls](const std::vector<double>& values) {
+                ++n_calls;
+                return values[0] - values[1];
+            },
+            nullptr, "g-r", {mag_g, mag_r});
+    CHECK_EQ(colour.get_inputs_derived().size(), 2);
+    CHECK_EQ(colour.get_value(), doctest::Approx(2.5));
+    CHECK_EQ(colour.get_value(), doctest::Approx(2.5));
+    CHECK_EQ(n_calls, 1);
+
+    const auto version = mag_g->get_version();
+    flux_r->set_value(10.);
+    CHECK_EQ(mag_g->get_version(), version);
+    CHECK_EQ(colour.get_stale(), true);
+    CHECK_EQ(colour.get_value(), doctest::Approx(0.));
+    CHECK_EQ(n_calls, 2);
+    flux_g->set_value(100.);
+    CHECK_GT(mag_g->get_version(), version);
+    CHECK_EQ(colour.get_value(), doctest::Approx(-2.5));
+    CHECK_EQ(colour.get_derivatives()[0], doctest::Approx(1.));
+    CHECK_EQ(colour.get_derivatives()[1], doctest::Approx(-1.));
+    CHECK_NE(colour.str().find("mag_g"), std::string::npos);
+}
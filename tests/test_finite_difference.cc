@@ -0,0 +1,165 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "lsst/modelfit/parameters/finite_difference.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+using Step = mod_params::FiniteDifference<double>::Step;
+
+TEST_CASE("FiniteDifference") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto fixed = std::make_shared<mod_params::RealParameter>(-1., nullptr, nullptr, nullptr, true);
+    auto real = std::make_shared<mod_params::RealParameter>(
+            3., std::make_shared<const mod_params::Limits<double>>(0., 3.));
+    auto collection = mod_params::ParameterCollection<double>({pos, fixed, real});
+
+    std::atomic<size_t> n_calls = 0;
+    auto function = [&n_calls](const std::vector<double>& values, std::vector<double>& output) {
+        ++n_calls;
+        // The fixed parameter's value is passed too
+        if (values[1] != -1.) throw std::logic_error("fixed parameter value changed");
+        output[0] = values[0] * values[2];
+        output[1] = values[0] * values[0] + values[2];
+    };
+    auto differ = mod_params::FiniteDifference<double>(collection, function, 2, 2);
+    CHECK_EQ(differ.get_n_threads(), 2);
+    CHECK_EQ(differ.get_scale(*pos), 1.);
+    CHECK_THROWS_AS(differ.set_scale(*pos, 0.), std::invalid_argument);
+
+    // The real parameter is at its upper limit and so is stepped backward
+    std::vector<double> steps;
+    std::vector<Step> kinds;
+    differ.compute_steps(steps, kinds);
+    CHECK_EQ(kinds, std::vector<Step>{Step::central, Step::backward});
+    CHECK_EQ(steps[0], doctest::Approx(differ.get_step_central()));
+    CHECK_EQ(steps[1], doctest::Approx(3. * differ.get_step_one_sided()));
+    differ.set_scale(*pos, 10.);
+    differ.compute_steps(steps, kinds);
+    CHECK_EQ(steps[0], doctest::Approx(10. * differ.get_step_central()));
+
+    // Derivatives are with respect to transformed values, i.e. log(pos) for pos
+    std::vector<double> jacobian(4), output;
+    differ.compute_jacobian(jacobian, &output);
+    CHECK_EQ(n_calls, 4);
+    CHECK_EQ(output, std::vector<double>{6., 7.});
+    CHECK_EQ(jacobian[0], doctest::Approx(6.).epsilon(1e-8));
+    CHECK_EQ(jacobian[1], doctest::Approx(8.).epsilon(1e-8));
+    CHECK_EQ(jacobian[2], doctest::Approx(2.).epsilon(1e-6));
+    CHECK_EQ(jacobian[3], doctest::Approx(1.).epsilon(1e-6));
+    // Parameters are left unchanged
+    CHECK_EQ(pos->get_value(), 2.);
+    CHECK_EQ(real->get_value(), 3.);
+
+    std::vector<double> jacobian_serial(4);
+    auto differ_serial = mod_params::FiniteDifference<double>(collection, function, 2);
+    differ_serial.set_scale(*pos, 10.);
+    differ_serial.compute_jacobian(jacobian_serial);
+    CHECK_EQ(jacobian_serial, jacobian);
+
+    // Parameters that can't be moved have zero derivatives
+    real->set_limits(std::make_shared<const mod_params::Limits<double>>(3., 3.));
+    differ.compute_jacobian(jacobian);
+    CHECK_EQ(jacobian[2], 0.);
+    CHECK_EQ(jacobian[3], 0.);
+    CHECK_THROWS_AS(differ.compute_jacobian(output), std::invalid_argument);
+}
+
+TEST_CASE("FiniteDifference errors") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto other = std::make_shared<mod_params::RealParameter>(2.);
+    auto collection = mod_params::ParameterCollection<double>({real, other});
+    auto function = [](const std::vector<double>& values, std::vector<double>& output) {
+        if (values[1] != 2.) throw std::domain_error("perturbed");
+        output[0] = values[0];
+    };
+    auto differ = mod_params::FiniteDifference<double>(collection, function, 1, 0);
+    CHECK_GE(differ.get_n_threads(), 1);
+    std::vector<double> jacobian(2);
+    CHECK_THROWS_AS(differ.compute_jacobian(jacobian), std::domain_error);
+
+    auto resize = [](const std::vector<double>&, std::vector<double>& output) { output.resize(3); };
+    CHECK_THROWS_AS(mod_params::FiniteDifference<double>(collection, resize, 1).compute_jacobian(jacobian),
+                    std::runtime_error);
+    CHECK_THROWS_AS(mod_params::FiniteDifference<double>(collection, nullptr, 1), std::invalid_argument);
+}
+
+TEST_CASE("FiniteDifference ties") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto dependent = std::make_shared<mod_params::RealParameter>(0.);
+    auto angle = std::make_shared<mod_params::AngleParameter>(0.);
+    auto collection = mod_params::ParameterCollection<double>({real, dependent, angle});
+    collection.tie(dependent, *real, 2.);
+    collection.tie(angle, *real, 1., 358.);
+    CHECK_EQ(angle->get_value(), 359.);
+
+    // Tied values are updated in the copies passed to the function, and the parameters aren't set
+    std::atomic<bool> changed = false;
+    auto function = [&](const std::vector<double>& values, std::vector<double>& output) {
+        changed = changed || (real->get_value() != 1.) || (dependent->get_value() != 2.)
+                  || (angle->get_value() != 359.);
+        output[0] = values[0] + values[1];
+        output[1] = values[2];
+    };
+    auto differ = mod_params::FiniteDifference<double>(collection, function, 2, 2);
+    CHECK_EQ(differ.get_n_threads(), 2);
+    std::vector<double> jacobian(2);
+    differ.compute_jacobian(jacobian);
+    CHECK_EQ(jacobian[0], doctest::Approx(3.).epsilon(1e-8));
+    CHECK_EQ(jacobian[1], doctest::Approx(1.).epsilon(1e-6));
+    CHECK_FALSE(changed);
+    CHECK_EQ(real->get_value(), 1.);
+    CHECK_EQ(dependent->get_value(), 2.);
+    CHECK_EQ(angle->get_value(), 359.);
+
+    // Tied values are wrapped into periodic limits
+    real->set_value(2.);
+    collection.update_ties();
+    CHECK_EQ(angle->get_value(), 0.);
+    std::vector<double> output;
+    std::atomic<bool> outside = false;
+    auto wrapped = [&outside](const std::vector<double>& values, std::vector<double>& output) {
+        outside = outside || !(values[2] >= 0. && values[2] < 360.);
+        output[0] = values[2];
+        output[1] = 0.;
+    };
+    mod_params::FiniteDifference<double>(collection, wrapped, 2).compute_jacobian(jacobian, &output);
+    CHECK_FALSE(outside);
+    CHECK_EQ(output[0], 0.);
+    CHECK_EQ(angle->get_value(), 0.);
+}
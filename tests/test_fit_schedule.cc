@@ -0,0 +1,126 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include "lsst/modelfit/parameters/fit_schedule.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("FitSchedule") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto flux = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto size = std::make_shared<mod_params::PositiveParameter>(3., nullptr, transform_log);
+    auto cen = std::make_shared<mod_params::RealParameter>(1.);
+    auto cen_tied = std::make_shared<mod_params::RealParameter>(0.);
+    auto collection = mod_params::ParameterCollection<double>({flux, size, cen, cen_tied});
+    collection.tie(cen_tied, *cen);
+
+    auto schedule = mod_params::FitSchedule<double>(collection);
+    CHECK_EQ(schedule.add_stage("fluxes", {flux}), 0);
+    CHECK_EQ(schedule.add_stage("sizes", {flux, size}), 1);
+    CHECK_EQ(schedule.add_stage("all", {flux, size, cen, cen_tied}), 2);
+    CHECK_EQ(schedule.get_n_stages(), 3);
+    CHECK_EQ(schedule.get_stage_index(), 3);
+    std::vector<double> values(1);
+    CHECK_THROWS_AS(schedule.get_values(values), std::logic_error);
+    CHECK_THROWS_AS(schedule.set_stage(3), std::out_of_range);
+    CHECK_EQ(schedule.get_stage(2).indices_free, std::vector<size_t>{0, 1, 2});
+
+    schedule.set_stage(0);
+    CHECK_EQ(schedule.get_n_free(), 1);
+    CHECK_EQ(collection.get_n_free(), 1);
+    CHECK_EQ(size->get_fixed(), true);
+    schedule.set_values_transformed({0.});
+    CHECK_EQ(flux->get_value(), 1.);
+
+    schedule.set_stage(1);
+    CHECK_EQ(size->get_free(), true);
+    CHECK_EQ(cen->get_fixed(), true);
+    values.resize(2);
+    schedule.get_values(values);
+    CHECK_EQ(values, std::vector<double>{1., 3.});
+
+    schedule.set_stage(2);
+    values.resize(3);
+    schedule.get_values_transformed(values);
+    std::vector<double> values_collection(collection.get_n_free());
+    collection.get_values_transformed(values_collection);
+    CHECK_EQ(values, values_collection);
+    CHECK_EQ(schedule.set_values({1., 2., 5.}), 0.);
+    CHECK_EQ(cen_tied->get_value(), 5.);
+    CHECK_THROWS_AS(schedule.set_values({1.}), std::invalid_argument);
+
+    // Changes to other parameters' free status don't invalidate the stage
+    mod_params::RealParameter().set_fixed(true);
+    schedule.get_values(values);
+
+    // Status changed outside of the schedule is reset when switching stages
+    cen->set_fixed(true);
+    size->set_fixed(true);
+    CHECK_THROWS_AS(schedule.get_values(values), std::logic_error);
+    schedule.set_stage(1);
+    CHECK_EQ(size->get_free(), true);
+    CHECK_EQ(cen->get_fixed(), true);
+    schedule.set_stage(2);
+    CHECK_EQ(cen->get_free(), true);
+
+    // Parameters added to the collection are fixed in existing stages
+    auto extra = std::make_shared<mod_params::RealParameter>(0.);
+    collection.add(extra);
+    CHECK_THROWS_AS(schedule.get_values(values), std::logic_error);
+    schedule.set_stage(0);
+    CHECK_EQ(extra->get_fixed(), true);
+    CHECK_EQ(collection.get_n_free(), 1);
+    collection.untie(*cen_tied);
+    schedule.set_stage(2);
+    CHECK_EQ(schedule.get_stage(2).indices_free, std::vector<size_t>{0, 1, 2, 3});
+    CHECK_EQ(schedule.get_n_free(), collection.get_n_free());
+}
+
+TEST_CASE("FitSchedule add_stage after collection.add") {
+    auto flux = std::make_shared<mod_params::PositiveParameter>(2.);
+    auto collection = mod_params::ParameterCollection<double>({flux});
+    auto schedule = mod_params::FitSchedule<double>(collection);
+    schedule.add_stage("flux", {flux});
+    schedule.set_stage(0);
+
+    // Adding a stage recomputes stages, but doesn't fix the new (free) parameter
+    auto size = std::make_shared<mod_params::PositiveParameter>(3.);
+    collection.add(size);
+    CHECK_EQ(schedule.add_stage("all", {flux, size}), 1);
+    CHECK_THROWS_AS(schedule.get_n_free(), std::logic_error);
+    schedule.set_stage(0);
+    CHECK_EQ(size->get_fixed(), true);
+    CHECK_EQ(schedule.get_n_free(), 1);
+    CHECK_EQ(collection.get_n_free(), 1);
+    schedule.set_stage(1);
+    CHECK_EQ(size->get_free(), true);
+    CHECK_EQ(schedule.get_n_free(), collection.get_n_free());
+}
@@ -0,0 +1,139 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define LSST_MODELFIT_PARAMETERS_INSTRUMENT
+
+#include "doctest.h"
+
+#include "lsst/modelfit/parameters/collection.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("Instrumentation") {
+    CHECK_EQ(mod_params::Instrumentation::enabled(), true);
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<mod_params::Limits<double>>(0.5, 2.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(1., limits, transform);
+    auto real = std::make_shared<mod_params::RealParameter>(0.);
+    mod_params::Instrumentation::reset();
+
+    pos->set_value(2.);
+    pos->set_value_transformed(0.);
+    CHECK_THROWS(pos->set_value(3.));
+    pos->set_value<mod_params::LimitPolicy::clip>(3.);
+    CHECK_THROWS(pos->set_limits(std::make_shared<mod_params::Limits<double>>(-1., 1.)));
+    real->set_value(1.);
+    auto collection = mod_params::ParameterCollection<double>({pos, real});
+    std::vector<double> gradient = {1., 1.};
+    collection.transform_gradient(gradient);
+
+    const auto& counters = mod_params::Instrumentation::get_counters(pos->get_name());
+    CHECK_EQ(counters.set_value, 4);
+    CHECK_EQ(counters.limit_rejections, 1);
+    CHECK_EQ(counters.clips, 1);
+    CHECK_EQ(counters.forward, 3);
+    CHECK_EQ(counters.reverse, 1);
+    CHECK_EQ(counters.derivative, 1);
+    CHECK_EQ(counters.throws, 2);
+    const auto& counters_real = mod_params::Instrumentation::get_counters(real->get_name());
+    // Parameters return their type's registered counters without a lookup
+    CHECK_EQ(&pos->get_counters(), &counters);
+    CHECK_EQ(&real->get_counters(), &counters_real);
+    CHECK_EQ(counters_real.set_value, 1);
+    CHECK_EQ(counters_real.throws, 0);
+
+    auto names = mod_params::Instrumentation::get_names();
+    CHECK_EQ(names.size(), 2);
+    auto report = mod_params::Instrumentation::report();
+    CHECK_NE(report.find("\"positive\": {\"set_value\": 4,"), std::string::npos);
+    mod_params::Instrumentation::reset();
+    CHECK_EQ(counters.set_value, 0);
+}
+
+TEST_CASE("Instrumentation apply_step") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(1., nullptr, transform);
+    auto collection = mod_params::ParameterCollection<double>({pos});
+    mod_params::Instrumentation::reset();
+
+    // A step within limits reverses each value once and transforms it again unless exact
+    collection.apply_step({1.}, 0.5);
+    const auto& counters = mod_params::Instrumentation::get_counters(pos->get_name());
+    CHECK_EQ(counters.set_value, 1);
+    CHECK_EQ(counters.reverse, 1);
+    CHECK_EQ(counters.forward, 1);
+    pos->set_transformed_exact(true);
+    mod_params::Instrumentation::reset();
+    collection.apply_step({1.}, 0.5);
+    CHECK_EQ(counters.reverse, 1);
+    CHECK_EQ(counters.forward, 0);
+    CHECK_EQ(pos->get_value_transformed(), 1.);
+}
+
+TEST_CASE("Instrumentation set_transformed_lazy") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(1., nullptr, transform);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 1., nullptr, transform);
+    auto collection = mod_params::ParameterCollection<double>({pos, array->get_element(0)});
+    collection.add(array->get_element(1));
+    collection.set_transformed_lazy(true);
+    collection.add(array->get_element(2));
+    CHECK_EQ(array->get_transformed_lazy(), true);
+    mod_params::Instrumentation::reset();
+
+    // Setting values repeatedly doesn't transform them until they're read
+    for (double value : {2., 3., 4.}) {
+        pos->set_value(value);
+        array->set_values({value, value, value});
+    }
+    const auto& counters = mod_params::Instrumentation::get_counters(pos->get_name());
+    const auto& counters_array = mod_params::Instrumentation::get_counters(array->get_element(0)->get_name());
+    CHECK_EQ(&array->get_element(2)->get_counters(), &counters_array);
+    CHECK_EQ(counters.set_value, 3);
+    CHECK_EQ(counters.forward, 0);
+    CHECK_EQ(counters_array.set_value, 9);
+    CHECK_EQ(counters_array.forward, 0);
+
+    // Gathering transforms each value once, with one batch for the array
+    std::vector<double> values(4);
+    collection.get_values_transformed(values);
+    for (double value : values) CHECK_EQ(value, log(4.));
+    CHECK_EQ(pos->get_value_transformed(), log(4.));
+    CHECK_EQ(counters.forward, 1);
+    CHECK_EQ(counters_array.forward, 3);
+
+    // Disabling lazy mode computes any stale values
+    array->set_value(1, 2.);
+    CHECK_EQ(counters_array.forward, 3);
+    collection.set_transformed_lazy(false);
+    CHECK_EQ(counters.forward, 1);
+    CHECK_EQ(counters_array.forward, 6);
+    CHECK_EQ(array->get_value_transformed(1), log(2.));
+    pos->set_value(2.);
+    CHECK_EQ(counters.forward, 2);
+}
@@ -25,10 +25,15 @@
 
 #include "doctest.h"
 
+#include <cmath>
 #include <limits>
+#include <stdexcept>
+#include <vector>
 
 #include "lsst/modelfit/parameters/limits.h"
 
+#include "transforms.h"
+
 namespace mod_params = lsst::modelfit::parameters;
 
 TEST_CASE("Limits") {
@@ -51,3 +56,103 @@ TEST_CASE("Limits") {
     CHECK_GT(limits.repr().size(), 0);
     CHECK_GT(limits.str().size(), 0);
 }
+
+TEST_CASE("Limits periodic") {
+    double inf = std::numeric_limits<double>::infinity();
+    CHECK_THROWS_AS(mod_params::Limits<double>(0, inf, "", true), std::invalid_argument);
+    CHECK_THROWS_AS(mod_params::Limits<double>(1, 1, "", true), std::invalid_argument);
+    auto limits = mod_params::Limits<double>(-180, 180, "angle", true);
+    CHECK_EQ(limits.get_periodic(), true);
+    CHECK_EQ(limits.get_period(), 360);
+    CHECK_EQ(mod_params::Limits<double>(-180, 180).get_period(), 0);
+    CHECK_THROWS_AS(limits.set_max(-180), std::invalid_argument);
+    CHECK_THROWS_AS(limits.set_min(-inf), std::invalid_argument);
+
+    CHECK_EQ(limits.wrap(0), 0);
+    CHECK_EQ(limits.wrap(-180), -180);
+    CHECK_EQ(limits.wrap(180), -180);
+    CHECK_EQ(limits.wrap(190), doctest::Approx(-170));
+    CHECK_EQ(limits.wrap(-190), doctest::Approx(170));
+    CHECK_EQ(limits.wrap(720 + 45), doctest::Approx(45));
+    CHECK_EQ(limits.wrap(-1e-300), -1e-300);
+    CHECK(std::isnan(limits.wrap(inf)));
+    CHECK(std::isnan(limits.wrap(NAN)));
+    // Values just below min wrap to within [min, max) despite rounding
+    const double below = std::nextafter(-180., -inf);
+    CHECK(limits.check(limits.wrap(below)));
+    CHECK_LT(limits.wrap(below), 180);
+
+    const std::vector<double> values = {0, 180, 190, -190, 765, below};
+    std::vector<double> wrapped(values.size());
+    limits.wrap_batch(values.data(), wrapped.data(), values.size());
+    for (size_t i = 0; i < values.size(); ++i) CHECK_EQ(wrapped[i], limits.wrap(values[i]));
+    auto in_place = values;
+    limits.wrap_batch(in_place.data(), in_place.data(), in_place.size());
+    CHECK_EQ(in_place, wrapped);
+
+    // Non-periodic limits don't wrap
+    auto limits_clip = mod_params::Limits<double>(-180, 180);
+    CHECK_EQ(limits_clip.wrap(190), 190);
+    limits_clip.wrap_batch(values.data(), wrapped.data(), values.size());
+    CHECK_EQ(wrapped, values);
+    CHECK_NE(limits.str(), limits_clip.str());
+}
+
+TEST_CASE("LimitPolicy") {
+    double inf = std::numeric_limits<double>::infinity();
+    auto limits = mod_params::Limits<double>(0, 1);
+    CHECK_EQ(limits.reflect(0.5), 0.5);
+    CHECK_EQ(limits.reflect(1.25), doctest::Approx(0.75));
+    CHECK_EQ(limits.reflect(-0.25), doctest::Approx(0.25));
+    CHECK_EQ(limits.reflect(2.25), doctest::Approx(0.25));
+    CHECK_EQ(limits.reflect(-1.75), doctest::Approx(0.25));
+    CHECK(std::isnan(limits.reflect(NAN)));
+    auto limits_half = mod_params::Limits<double>(1, inf);
+    CHECK_EQ(limits_half.reflect(-3), 5);
+    CHECK_EQ(mod_params::Limits<double>(2, 2).reflect(3), 2);
+
+    double value = 1.5;
+    CHECK_EQ(limits.enforce<mod_params::LimitPolicy::clip>(value), 0);
+    CHECK_EQ(value, 1);
+    value = -0.5;
+    CHECK_EQ(limits.enforce<mod_params::LimitPolicy::penalize>(value), 0.25);
+    CHECK_EQ(value, 0);
+    value = 1.5;
+    CHECK_EQ(limits.enforce<mod_params::LimitPolicy::reflect>(value), 0);
+    CHECK_EQ(value, doctest::Approx(0.5));
+
+    for (auto policy : {mod_params::LimitPolicy::error, mod_params::LimitPolicy::clip,
+                        mod_params::LimitPolicy::reflect, mod_params::LimitPolicy::penalize}) {
+        auto visited = mod_params::visit_limit_policy(policy, [](auto policy_c) {
+            return decltype(policy_c)::value;
+        });
+        CHECK_EQ(visited, policy);
+        CHECK_GT(mod_params::to_string(policy).size(), 0);
+    }
+}
+
+TEST_CASE("transform_limits") {
+    double inf = std::numeric_limits<double>::infinity();
+    const auto& unit = mod_params::UnitTransform<double>::get();
+    auto limits = mod_params::transform_limits(mod_params::Limits<double>(-1, 2, "unit"), unit, 0.);
+    CHECK_EQ(limits.get_min(), -1);
+    CHECK_EQ(limits.get_max(), 2);
+    CHECK_EQ(limits.name, "unit.transformed");
+
+    const mod_params::LogTransform<double> log_transform{};
+    limits = mod_params::transform_limits(mod_params::Limits<double>(), log_transform, 1.);
+    CHECK_EQ(limits.get_min(), -inf);
+    CHECK_EQ(limits.get_max(), inf);
+    limits = mod_params::transform_limits(mod_params::Limits<double>(1, 100), log_transform, 2.);
+    CHECK_EQ(limits.get_min(), 0);
+    CHECK_EQ(limits.get_max(), doctest::Approx(log(100.)));
+
+    const mod_params::NegativeLogTransform<double> neg_log{};
+    limits = mod_params::transform_limits(mod_params::Limits<double>(1, inf), neg_log, 2.);
+    CHECK_EQ(limits.get_min(), -inf);
+    CHECK_EQ(limits.get_max(), 0);
+    // The endpoints both transform to NaN, so the derivative gives the direction
+    limits = mod_params::transform_limits(mod_params::Limits<double>(-inf, -1), neg_log, -2.);
+    CHECK_EQ(limits.get_min(), -inf);
+    CHECK_EQ(limits.get_max(), inf);
+}
@@ -25,7 +25,11 @@
 
 #include "doctest.h"
 
+#include <set>
+#include <unordered_set>
+
 #include "parameters.h"
+#include "transforms.h"
 
 namespace mod_params = lsst::modelfit::parameters;
 
@@ -37,6 +41,16 @@ TEST_CASE("RealParameter") {
     real.set_unit(unit);
     CHECK_EQ(real.get_unit().get_name(), unit->get_name());
     CHECK_EQ(real.get_value(), 0);
+    const auto version = real.get_version();
+    real.set_value(1.);
+    real.set_value_transformed(0.);
+    CHECK_EQ(real.get_version(), version + 2);
+    CHECK_EQ(real.get_version_structure(), 0);
+    real.set_fixed(true);
+    real.set_fixed(true);
+    real.set_transform(transform);
+    CHECK_EQ(real.get_version_structure(), 2);
+    real.set_fixed(false);
     CHECK_GT(real.repr().size(), 0);
     CHECK_GT(real.str().size(), 0);
 
@@ -62,3 +76,144 @@ TEST_CASE("PositiveParameter") {
     auto pos = mod_params::PositiveParameter();
     CHECK_EQ(pos.get_min(), DBL_TRUE_MIN);
 }
+
+TEST_CASE("AngleParameter") {
+    auto angle = mod_params::AngleParameter(45.);
+    CHECK_EQ(angle.get_limits().get_periodic(), true);
+    angle.set_value(370.);
+    CHECK_EQ(angle.get_value(), doctest::Approx(10.));
+    angle.set_value(-90.);
+    CHECK_EQ(angle.get_value(), doctest::Approx(270.));
+    angle.set_value(360.);
+    CHECK_EQ(angle.get_value(), 0.);
+    CHECK_THROWS(angle.set_value(std::numeric_limits<double>::infinity()));
+    CHECK_EQ(angle.get_value(), 0.);
+
+    // The transformed value is always that of the wrapped value
+    auto transform = std::make_shared<mod_params::UnitTransform<double>>();
+    angle.set_transform(transform);
+    angle.set_value_transformed(-1.);
+    CHECK_EQ(angle.get_value(), doctest::Approx(359.));
+    CHECK_EQ(angle.get_value_transformed(), angle.get_value());
+    CHECK_EQ(angle.get_transform_derivative(), 1.);
+
+    // Periodic limits may also be set on an aperiodic parameter type
+    auto real = mod_params::RealParameter(0.);
+    real.set_limits(std::make_shared<const mod_params::Limits<double>>(-1., 1., "", true));
+    real.set_value(1.5);
+    CHECK_EQ(real.get_value(), doctest::Approx(-0.5));
+}
+
+TEST_CASE("LimitPolicy Parameter") {
+    auto limits = std::make_shared<const mod_params::Limits<double>>(1., 2.);
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = mod_params::PositiveParameter(1.5, limits, transform);
+
+    CHECK_THROWS(pos.set_value<mod_params::LimitPolicy::error>(3.));
+    CHECK_EQ(pos.set_value<mod_params::LimitPolicy::clip>(3.), 0.);
+    CHECK_EQ(pos.get_value(), 2.);
+    CHECK_EQ(pos.get_value_transformed(), doctest::Approx(log(2.)));
+    CHECK_EQ(pos.set_value<mod_params::LimitPolicy::reflect>(2.25), 0.);
+    CHECK_EQ(pos.get_value(), doctest::Approx(1.75));
+    CHECK_EQ(pos.set_value<mod_params::LimitPolicy::penalize>(0.5), doctest::Approx(0.25));
+    CHECK_EQ(pos.get_value(), 1.);
+    CHECK_EQ(pos.set_value_transformed<mod_params::LimitPolicy::clip>(log(4.)), 0.);
+    CHECK_EQ(pos.get_value(), 2.);
+    CHECK_EQ(pos.get_value_transformed(), doctest::Approx(log(2.)));
+    // NaN can't be clipped
+    CHECK_THROWS(pos.set_value<mod_params::LimitPolicy::clip>(NAN));
+    CHECK_EQ(pos.get_value(), 2.);
+
+    // The runtime policy (virtual) path
+    mod_params::ParameterBase<double>& base = pos;
+    CHECK_THROWS(base.set_value(3., mod_params::LimitPolicy::error));
+    CHECK_EQ(base.set_value(4., mod_params::LimitPolicy::penalize), doctest::Approx(4.));
+    CHECK_EQ(base.get_value(), 2.);
+    CHECK_EQ(base.set_value_transformed(log(0.5), mod_params::LimitPolicy::reflect), 0.);
+    CHECK_EQ(base.get_value(), doctest::Approx(1.5));
+}
+
+TEST_CASE("Parameter get_limits_transformed") {
+    double inf = std::numeric_limits<double>::infinity();
+    auto limits = std::make_shared<const mod_params::Limits<double>>(1., 100.);
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = mod_params::PositiveParameter(2., limits, transform);
+    const auto& limits_transformed = pos.get_limits_transformed();
+    CHECK_EQ(limits_transformed.get_min(), 0.);
+    CHECK_EQ(limits_transformed.get_max(), doctest::Approx(log(100.)));
+    pos.set_value(50.);
+    CHECK_EQ(&pos.get_limits_transformed(), &limits_transformed);
+    CHECK_EQ(limits_transformed.get_max(), doctest::Approx(log(100.)));
+
+    pos.set_transform(std::make_shared<mod_params::NegativeLogTransform<double>>());
+    CHECK_EQ(limits_transformed.get_min(), doctest::Approx(-log(100.)));
+    CHECK_EQ(limits_transformed.get_max(), 0.);
+    pos.set_limits(nullptr);
+    CHECK_EQ(limits_transformed.get_min(), -inf);
+    CHECK_EQ(limits_transformed.get_max(), doctest::Approx(-log(DBL_TRUE_MIN)));
+
+    auto real = mod_params::RealParameter();
+    CHECK_EQ(real.get_limits_transformed().get_min(), -inf);
+    CHECK_EQ(real.get_limits_transformed().get_max(), inf);
+}
+
+TEST_CASE("Parameter set_transformed_exact") {
+    auto limits = std::make_shared<const mod_params::Limits<double>>(0.5, 100.);
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = mod_params::PositiveParameter(1., limits, transform);
+    CHECK_EQ(pos.get_transformed_exact(), false);
+    pos.set_transformed_exact(true);
+    CHECK_EQ(pos.get_transformed_exact(), true);
+
+    const double value_transformed = 0.1;
+    CHECK_LT(transform->round_trip_error(value_transformed), 1e-15);
+    pos.set_value_transformed(value_transformed);
+    CHECK_EQ(pos.get_value_transformed(), value_transformed);
+    CHECK_EQ(pos.get_value(), doctest::Approx(exp(value_transformed)));
+    // Clipped values are transformed again
+    pos.set_value_transformed<mod_params::LimitPolicy::clip>(log(1000.));
+    CHECK_EQ(pos.get_value(), 100.);
+    CHECK_EQ(pos.get_value_transformed(), log(100.));
+}
+
+TEST_CASE("Parameter set_transformed_lazy") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = mod_params::PositiveParameter(1., nullptr, transform);
+    pos.set_transformed_lazy(true);
+    CHECK_EQ(pos.get_transformed_lazy(), true);
+    pos.set_value(2.);
+    CHECK_EQ(pos.get_value_transformed(), log(2.));
+    pos.set_transform(nullptr);
+    CHECK_EQ(pos.get_value_transformed(), 2.);
+    // Given transformed values are only stored if exact
+    pos.set_value_with_transformed(3., 4., mod_params::LimitPolicy::error);
+    CHECK_EQ(pos.get_value_transformed(), 3.);
+    pos.set_transformed_exact(true);
+    pos.set_value_with_transformed(3., 4., mod_params::LimitPolicy::error);
+    CHECK_EQ(pos.get_value_transformed(), 4.);
+    pos.set_transformed_exact(false);
+    pos.set_value(5.);
+    pos.set_transformed_lazy(false);
+    CHECK_EQ(pos.get_value_transformed(), 5.);
+}
+
+TEST_CASE("Parameter ids") {
+    auto first = std::make_shared<mod_params::RealParameter>(1.);
+    auto second = std::make_shared<mod_params::PositiveParameter>(1.);
+    auto third = std::make_shared<mod_params::RealParameter>(1.);
+    CHECK_EQ(second->get_id(), first->get_id() + 1);
+    CHECK_EQ(third->get_id(), first->get_id() + 2);
+    CHECK_LT(*first, *second);
+    CHECK_LT(*second, *third);
+
+    std::set<std::shared_ptr<mod_params::ParameterBase<double>>, mod_params::ParameterIdLess> ordered
+            = {third, first, second};
+    std::vector<size_t> ids;
+    for (const auto& parameter : ordered) ids.push_back(parameter->get_id());
+    CHECK_EQ(ids, std::vector<size_t>{first->get_id(), second->get_id(), third->get_id()});
+
+    std::unordered_set<std::shared_ptr<mod_params::ParameterBase<double>>, mod_params::ParameterIdHash>
+            hashed = {first, second, first};
+    CHECK_EQ(hashed.size(), 2);
+    CHECK_EQ(mod_params::ParameterIdHash{}(*first), std::hash<size_t>{}(first->get_id()));
+}
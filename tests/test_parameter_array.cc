@@ -0,0 +1,163 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include "lsst/modelfit/parameters/collection.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ParameterArray") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<mod_params::Limits<double>>(0.5, 100.);
+    auto fluxes = std::make_shared<mod_params::PositiveParameterArray>(4, 1., limits, transform, nullptr,
+                                                                       false, "flux");
+    CHECK_EQ(fluxes->size(), 4);
+    CHECK_EQ(fluxes->get_value(2), 1.);
+    CHECK_EQ(fluxes->get_value_transformed(2), 0.);
+    CHECK_GT(fluxes->repr().size(), 0);
+    CHECK_GT(fluxes->str().size(), 0);
+
+    fluxes->set_value(1, 10.);
+    CHECK_EQ(fluxes->get_value_transformed(1), doctest::Approx(log(10.)));
+    CHECK_THROWS(fluxes->set_value(1, 0.));
+    CHECK_EQ(fluxes->get_value(1), 10.);
+    fluxes->set_values_transformed({0., log(2.), log(3.), log(4.)});
+    CHECK_EQ(fluxes->get_values()[3], doctest::Approx(4.));
+    CHECK_THROWS(fluxes->set_values({1., 2., 3., 1000.}));
+    CHECK_EQ(fluxes->get_values()[3], doctest::Approx(4.));
+    CHECK_THROWS(fluxes->set_values({1.}));
+    CHECK_THROWS(fluxes->set_limits(std::make_shared<mod_params::Limits<double>>(2., 3.)));
+    CHECK_EQ(fluxes->get_limits_transformed().get_min(), doctest::Approx(log(0.5)));
+    CHECK_EQ(fluxes->get_limits_transformed().get_max(), doctest::Approx(log(100.)));
+
+    auto element = fluxes->get_element(2);
+    CHECK_EQ(element->get_index(), 2);
+    CHECK_EQ(element->get_label(), "flux[2]");
+    CHECK_EQ(element->get_name(), "positive_array");
+    CHECK_EQ(&element->get_transform(), transform.get());
+    CHECK_EQ(element->get_value(), doctest::Approx(3.));
+    CHECK_EQ(element->get_transform_derivative(), doctest::Approx(1. / 3.));
+    CHECK_EQ(element->get_min(), DBL_TRUE_MIN);
+    element->set_value_transformed(0.);
+    CHECK_EQ(fluxes->get_value(2), 1.);
+    CHECK_EQ(element, fluxes->get_element(2));
+    CHECK_THROWS(element->set_transform(nullptr));
+    CHECK_GT(element->repr().size(), 0);
+    CHECK_GT(element->str().size(), 0);
+
+    auto collection = mod_params::ParameterCollection<double>(fluxes->get_elements());
+    fluxes->set_free(0, false);
+    CHECK_EQ(element->get_fixed(), false);
+    CHECK_EQ(collection.get_n_free(), 3);
+    collection.set_values({5., 6., 7.});
+    CHECK_EQ(fluxes->get_values(), std::vector<double>{1., 5., 6., 7.});
+
+    // Elements keep the array alive
+    std::weak_ptr<mod_params::PositiveParameterArray> weak = fluxes;
+    fluxes.reset();
+    CHECK_EQ(weak.expired(), false);
+    CHECK_EQ(element->get_value(), 6.);
+}
+
+TEST_CASE("ParameterArray periodic") {
+    auto limits = std::make_shared<const mod_params::Limits<double>>(1., 3., "", true);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 1., limits);
+    array->set_value(0, 3.5);
+    CHECK_EQ(array->get_value(0), doctest::Approx(1.5));
+    array->set_values({0.5, 2., 7.});
+    CHECK_EQ(array->get_value(0), doctest::Approx(2.5));
+    CHECK_EQ(array->get_value(1), 2.);
+    CHECK_EQ(array->get_value(2), doctest::Approx(1.));
+    array->set_values_transformed({-1., 4., 2.});
+    CHECK_EQ(array->get_value(0), doctest::Approx(1.));
+    CHECK_EQ(array->get_value(1), doctest::Approx(2.));
+    CHECK_EQ(array->get_value(2), doctest::Approx(2.));
+    CHECK_EQ(array->get_values_transformed(), array->get_values());
+}
+
+TEST_CASE("ParameterArray LimitPolicy") {
+    auto limits = std::make_shared<const mod_params::Limits<double>>(1., 3.);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 2., limits);
+    const std::vector<double> values = {0.5, 2., 4.};
+    CHECK_THROWS(array->set_values(values));
+    CHECK_EQ(array->get_value(0), 2.);
+    CHECK_EQ(array->set_values<mod_params::LimitPolicy::clip>(values), 0.);
+    CHECK_EQ(array->get_values(), std::vector<double>{1., 2., 3.});
+    // The caller's values are unmodified
+    CHECK_EQ(values[0], 0.5);
+    CHECK_EQ(array->set_values(values, mod_params::LimitPolicy::penalize), doctest::Approx(1.25));
+    CHECK_EQ(array->set_values_transformed<mod_params::LimitPolicy::reflect>(values), 0.);
+    CHECK_EQ(array->get_values()[0], doctest::Approx(1.5));
+    CHECK_EQ(array->get_values()[2], doctest::Approx(2.));
+    CHECK_THROWS(array->set_values<mod_params::LimitPolicy::clip>({1., NAN, 2.}));
+    CHECK_EQ(array->get_values()[1], 2.);
+
+    CHECK_EQ(array->set_value<mod_params::LimitPolicy::penalize>(1, 5.), doctest::Approx(4.));
+    CHECK_EQ(array->get_value(1), 3.);
+    auto element = array->get_element(1);
+    CHECK_EQ(element->set_value(0., mod_params::LimitPolicy::clip), 0.);
+    CHECK_EQ(array->get_value(1), 1.);
+}
+
+TEST_CASE("ParameterArray set_transformed_exact") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto limits = std::make_shared<const mod_params::Limits<double>>(0.5, 100.);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 1., limits, transform);
+    array->set_transformed_exact(true);
+    CHECK_EQ(array->get_element(0)->get_transformed_exact(), true);
+    CHECK_THROWS_AS(array->get_element(0)->set_transformed_exact(false), std::logic_error);
+
+    const std::vector<double> values_transformed = {0.1, 0.2, 0.3};
+    array->set_values_transformed(values_transformed);
+    CHECK_EQ(array->get_values_transformed(), values_transformed);
+    CHECK_EQ(array->get_value(2), doctest::Approx(exp(0.3)));
+    array->set_value_transformed(1, 0.7);
+    CHECK_EQ(array->get_value_transformed(1), 0.7);
+
+    array->set_values_transformed<mod_params::LimitPolicy::clip>({0.1, 0.2, 10.});
+    CHECK_EQ(array->get_value(2), 100.);
+    CHECK_EQ(array->get_value_transformed(2), log(100.));
+}
+
+TEST_CASE("ParameterArray set_transformed_lazy") {
+    auto transform = std::make_shared<mod_params::LogTransform<double>>();
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 1., nullptr, transform);
+    auto element = array->get_element(1);
+    element->set_transformed_lazy(true);
+    CHECK_EQ(array->get_transformed_lazy(), true);
+    array->set_values({1., 2., 3.});
+    CHECK_EQ(element->get_value_transformed(), log(2.));
+    array->set_value(2, 4.);
+    CHECK_EQ(array->get_values_transformed(), std::vector<double>{0., log(2.), log(4.)});
+    array->set_value(0, 2.);
+    array->set_value_with_transformed(1, 3., 0.5);
+    CHECK_EQ(array->get_value_transformed(0), log(2.));
+    CHECK_EQ(array->get_value_transformed(1), log(3.));
+}
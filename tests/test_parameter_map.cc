@@ -0,0 +1,107 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lsst/modelfit/parameters/collection.h"
+#include "lsst/modelfit/parameters/parameter_map.h"
+
+#include "parameters.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ParameterMap") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2.);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(2);
+    auto element = array->get_element(1);
+
+    auto map = mod_params::ParameterMap<double, std::string>();
+    CHECK_EQ(map.size(), 0);
+    CHECK_EQ(map.contains(*real), false);
+    CHECK_THROWS_AS(map.at(*real), std::out_of_range);
+
+    map.set(*pos, "pos");
+    map[*element] = "element";
+    CHECK_EQ(map.size(), 2);
+    CHECK_EQ(map.at(*pos), "pos");
+    CHECK_EQ(map.at(*element), "element");
+    CHECK_EQ(map.contains(*real), false);
+    CHECK_EQ(map.contains(*array->get_element(0)), false);
+
+    map[*pos] += "itive";
+    CHECK_EQ(map.at(*pos), "positive");
+    CHECK_EQ(map.size(), 2);
+    CHECK_EQ(map.erase(*pos), true);
+    CHECK_EQ(map.erase(*pos), false);
+    CHECK_EQ(map.size(), 1);
+    CHECK_EQ(map.contains(*pos), false);
+    CHECK_EQ(map.at(*element), "element");
+    map.clear();
+    CHECK_EQ(map.contains(*element), false);
+    CHECK_EQ(map.size(), 0);
+}
+
+TEST_CASE("ParameterMap erase and growth") {
+    std::vector<std::shared_ptr<mod_params::RealParameter>> params;
+    for (size_t idx = 0; idx < 1000; ++idx) {
+        params.push_back(std::make_shared<mod_params::RealParameter>(idx));
+    }
+
+    auto map = mod_params::ParameterMap<double, size_t>();
+    for (size_t idx = 0; idx < params.size(); ++idx) map[*params[idx]] = idx;
+    CHECK_EQ(map.size(), params.size());
+    CHECK_LE(map.capacity(), 8 * params.size());
+    // Erasing must keep the rest of each probe sequence reachable
+    for (size_t idx = 0; idx < params.size(); idx += 3) CHECK_EQ(map.erase(*params[idx]), true);
+    for (size_t idx = 0; idx < params.size(); ++idx) {
+        if (idx % 3 == 0) {
+            CHECK_EQ(map.contains(*params[idx]), false);
+        } else {
+            CHECK_EQ(map.at(*params[idx]), idx);
+        }
+    }
+}
+
+TEST_CASE("ParameterMap sparse ids") {
+    // Create (and destroy) many parameters so that the next id is large
+    for (size_t idx = 0; idx < 100000; ++idx) mod_params::RealParameter();
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    CHECK_GE(real->get_id(), 100000);
+
+    auto map = mod_params::ParameterMap<double, double>();
+    map[*real] = 2.;
+    CHECK_EQ(map.at(*real), 2.);
+    CHECK_LT(map.capacity(), 100);
+
+    auto collection = mod_params::ParameterCollection<double>({real});
+    CHECK_EQ(collection.get_index(*real), 0);
+}
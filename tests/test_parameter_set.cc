@@ -0,0 +1,117 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "lsst/modelfit/parameters/parameter_set.h"
+
+#include "parameters.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ParameterSet") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., nullptr, nullptr, nullptr, true);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(2);
+    auto set = mod_params::ParameterSet<double>({pos, real, pos});
+    CHECK_EQ(set.size(), 2);
+    CHECK_EQ(set.add(real), false);
+    CHECK_EQ(set.add_all(array->get_elements()), 2);
+    CHECK_EQ(set.add_all(array->get_elements()), 0);
+    CHECK_THROWS_AS(set.add(nullptr), std::invalid_argument);
+    CHECK_EQ(set.contains(*array->get_element(1)), true);
+    CHECK_EQ(set.contains(*std::make_shared<mod_params::RealParameter>()), false);
+
+    // Iteration is in insertion order
+    std::vector<double> values(set.size());
+    set.get_values(values);
+    CHECK_EQ(values, std::vector<double>{2., 1., 1., 1.});
+    std::vector<const mod_params::ParameterBase<double>*> ordered;
+    for (const auto& parameter : set) ordered.push_back(parameter.get());
+    CHECK_EQ(ordered[0], pos.get());
+    CHECK_EQ(ordered[1], real.get());
+
+    CHECK_EQ(set.get_free().size(), 3);
+    CHECK_EQ(set.get_linear().size(), 0);
+    CHECK_EQ(set.get_type<mod_params::RealParameter>().get_parameters().at(0), real);
+    CHECK_EQ(set.get_type<mod_params::PositiveParameterArray::Element>().size(), 2);
+
+    CHECK_EQ(set.set_values({3., 4., 5., 6.}), 0.);
+    CHECK_EQ(real->get_value(), 4.);
+    CHECK_EQ(array->get_value(1), 6.);
+    CHECK_THROWS_AS(set.set_values({1.}), std::invalid_argument);
+    set.set_fixed(true);
+    CHECK_EQ(set.get_free().empty(), true);
+
+    CHECK_EQ(set.erase(*real), true);
+    CHECK_EQ(set.erase(*real), false);
+    CHECK_EQ(set.contains(*real), false);
+    CHECK_EQ(set.get_parameters().at(1), array->get_element(0));
+    CHECK_EQ(set.contains(*array->get_element(1)), true);
+    set.clear();
+    CHECK_EQ(set.empty(), true);
+    CHECK_EQ(set.contains(*pos), false);
+}
+
+TEST_CASE("ParameterSet large") {
+    std::vector<std::shared_ptr<mod_params::ParameterBase<double>>> parameters;
+    for (size_t idx = 0; idx < 1000; ++idx) {
+        parameters.emplace_back(std::make_shared<mod_params::RealParameter>());
+    }
+    mod_params::ParameterSet<double> set;
+    for (int repeat = 0; repeat < 3; ++repeat) set.add_all(parameters);
+    CHECK_EQ(set.size(), 1000);
+    CHECK_EQ(set.get_parameters(), parameters);
+    for (const auto& parameter : parameters) CHECK_EQ(set.contains(*parameter), true);
+
+    // Erasing keeps the remaining parameters in order and findable
+    std::vector<std::shared_ptr<mod_params::ParameterBase<double>>> kept;
+    for (size_t idx = 0; idx < parameters.size(); ++idx) {
+        if (idx % 3 == 0) {
+            CHECK_EQ(set.erase(*parameters[idx]), true);
+        } else {
+            kept.push_back(parameters[idx]);
+        }
+    }
+    CHECK_EQ(set.get_parameters(), kept);
+    for (size_t idx = 0; idx < parameters.size(); ++idx) {
+        CHECK_EQ(set.contains(*parameters[idx]), idx % 3 != 0);
+    }
+    CHECK_EQ(set.erase(*kept.back()), true);
+    kept.pop_back();
+    CHECK_EQ(set.add(parameters[0]), true);
+    kept.push_back(parameters[0]);
+    CHECK_EQ(set.get_parameters(), kept);
+    CHECK_EQ(set.erase(*kept.front()), true);
+    kept.erase(kept.begin());
+    CHECK_EQ(set.erase(*parameters[0]), true);
+    kept.pop_back();
+    CHECK_EQ(set.get_parameters(), kept);
+}
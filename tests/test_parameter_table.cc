@@ -0,0 +1,78 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "lsst/modelfit/parameters/collection.h"
+#include "lsst/modelfit/parameters/parameter_table.h"
+
+#include "parameters.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ParameterTable") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2.);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(2);
+    auto element = array->get_element(1);
+
+    auto table = mod_params::ParameterTable<double, std::string>();
+    CHECK_EQ(table.size(), 0);
+    CHECK_EQ(table.contains(*real), false);
+    CHECK_THROWS_AS(table.at(*real), std::out_of_range);
+
+    table.set(*pos, "pos");
+    table[*element] = "element";
+    CHECK_EQ(table.size(), 2);
+    CHECK_EQ(table.at(*pos), "pos");
+    CHECK_EQ(table.at(*element), "element");
+    CHECK_EQ(table.contains(*real), false);
+    CHECK_EQ(table.contains(*array->get_element(0)), false);
+
+    table[*pos] += "itive";
+    CHECK_EQ(table.at(*pos), "positive");
+    CHECK_EQ(table.size(), 2);
+    CHECK_EQ(table.erase(*pos), true);
+    CHECK_EQ(table.erase(*pos), false);
+    CHECK_EQ(table.size(), 1);
+    CHECK_EQ(table.contains(*pos), false);
+    table.clear();
+    CHECK_EQ(table.contains(*element), false);
+    CHECK_EQ(table.size(), 0);
+}
+
+TEST_CASE("ParameterCollection get_index") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2.);
+    auto other = std::make_shared<mod_params::RealParameter>(3.);
+    auto collection = mod_params::ParameterCollection<double>({pos, real, pos});
+    CHECK_EQ(collection.get_index(*pos), 0);
+    CHECK_EQ(collection.get_index(*real), 1);
+    CHECK_THROWS_AS(collection.get_index(*other), std::invalid_argument);
+}
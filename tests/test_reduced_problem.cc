@@ -0,0 +1,157 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include "lsst/modelfit/parameters/reduced_problem.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ReducedProblem") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto fixed = std::make_shared<mod_params::RealParameter>(-1., nullptr, nullptr, nullptr, true);
+    auto real = std::make_shared<mod_params::RealParameter>(3.);
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(2, 1., nullptr, transform_log);
+    auto tied = std::make_shared<mod_params::RealParameter>(0.);
+    auto collection = mod_params::ParameterCollection<double>(
+            {pos, fixed, real, array->get_element(0), array->get_element(1), tied});
+    collection.tie(tied, *real, 2.);
+
+    auto problem = mod_params::ReducedProblem<double>(collection);
+    CHECK_EQ(problem.is_valid(), true);
+    CHECK_EQ(problem.get_n_free(), collection.get_n_free());
+    CHECK_EQ(problem.get_indices_free(), std::vector<size_t>{0, 2, 3, 4});
+    CHECK_EQ(problem.get_indices_fixed(), std::vector<size_t>{1});
+    CHECK_EQ(problem.get_values_fixed(), std::vector<double>{-1.});
+    // The positive parameter and array elements share a transform and so a plan
+    const auto& plans = problem.get_plans();
+    REQUIRE_EQ(plans.size(), 2);
+    CHECK_EQ(plans[0].transform, transform_log.get());
+    CHECK_EQ(plans[0].indices_free, std::vector<size_t>{0, 2, 3});
+    CHECK_EQ(plans[1].indices_free, std::vector<size_t>{1});
+    CHECK_EQ(plans[1].parameters, std::vector<mod_params::ParameterBase<double>*>{real.get()});
+
+    std::vector<double> values(4), values_collection(4);
+    problem.get_values(values);
+    collection.get_values(values_collection);
+    CHECK_EQ(values, values_collection);
+
+    problem.set_values_transformed({0., 1., log(2.), log(3.)});
+    CHECK_EQ(pos->get_value(), 1.);
+    CHECK_EQ(real->get_value(), 1.);
+    CHECK_EQ(tied->get_value(), 2.);
+    CHECK_EQ(array->get_value(1), doctest::Approx(3.));
+    problem.get_values_transformed(values);
+    collection.get_values_transformed(values_collection);
+    CHECK_EQ(values, values_collection);
+    CHECK_EQ(problem.set_values({1., 2., 3., 4.}), 0.);
+    CHECK_EQ(tied->get_value(), 4.);
+
+    // Setting values or unchanged free status keeps the view valid
+    fixed->set_value(0.);
+    pos->set_free(true);
+    CHECK_EQ(problem.is_valid(), true);
+    CHECK_EQ(problem.get_values_fixed(), std::vector<double>{-1.});
+
+    array->get_element(1)->set_fixed(true);
+    CHECK_EQ(problem.is_valid(), false);
+    CHECK_THROWS_AS(problem.get_values(values), std::logic_error);
+    problem.compile();
+    CHECK_EQ(problem.get_indices_fixed(), std::vector<size_t>{1, 4});
+    CHECK_EQ(problem.get_values_fixed(), std::vector<double>{0., 4.});
+    CHECK_THROWS_AS(problem.get_values(values), std::invalid_argument);
+
+    real->set_transform(nullptr);
+    CHECK_EQ(problem.is_valid(), false);
+    problem.compile();
+    collection.untie(*tied);
+    CHECK_EQ(problem.is_valid(), false);
+    problem.compile();
+    CHECK_EQ(problem.get_n_free(), 4);
+
+    auto softmax = std::make_shared<mod_params::SoftmaxTransform<double>>(2);
+    collection.add_vector_transform(softmax, {real, tied});
+    CHECK_THROWS_AS(problem.compile(), std::logic_error);
+}
+
+TEST_CASE("ReducedProblem other parameters") {
+    auto real = std::make_shared<mod_params::RealParameter>(1.);
+    auto other = std::make_shared<mod_params::RealParameter>(2.);
+    auto collection = mod_params::ParameterCollection<double>({real});
+    auto collection_other = mod_params::ParameterCollection<double>({other});
+    auto problem = mod_params::ReducedProblem<double>(collection);
+    auto problem_other = mod_params::ReducedProblem<double>(collection_other);
+
+    // Changing parameters outside the collection doesn't invalidate the view
+    const auto version = collection.get_structure_version_parameters();
+    other->set_fixed(true);
+    other->set_transform(std::make_shared<mod_params::LogTransform<double>>());
+    std::make_shared<mod_params::RealParameter>(3.)->set_fixed(true);
+    CHECK_EQ(collection.get_structure_version_parameters(), version);
+    CHECK_EQ(problem.is_valid(), true);
+    std::vector<double> values(1);
+    problem.get_values(values);
+    CHECK_EQ(values[0], 1.);
+    CHECK_EQ(problem_other.is_valid(), false);
+
+    // ... but changing (and restoring) its own parameters does
+    real->set_fixed(true);
+    real->set_fixed(false);
+    CHECK_GT(collection.get_structure_version_parameters(), version);
+    CHECK_EQ(problem.is_valid(), false);
+}
+
+TEST_CASE("ReducedProblem ties LimitPolicy") {
+    auto source = std::make_shared<mod_params::RealParameter>(0.5);
+    auto tied = std::make_shared<mod_params::RealParameter>(
+            0.5, std::make_shared<const mod_params::Limits<double>>(0., 1.));
+    auto collection = mod_params::ParameterCollection<double>({source, tied});
+    collection.tie(tied, *source);
+    auto problem = mod_params::ReducedProblem<double>(collection);
+    CHECK_EQ(problem.set_values_transformed({2.}, mod_params::LimitPolicy::penalize), 1.);
+    CHECK_EQ(tied->get_value(), 1.);
+    CHECK_EQ(problem.set_values({-2.}, mod_params::LimitPolicy::clip), 0.);
+    CHECK_EQ(tied->get_value(), 0.);
+}
+
+TEST_CASE("ReducedProblem set_transformed_exact") {
+    auto quantized = std::make_shared<mod_params::QuantizedTransform<double>>();
+    auto real = std::make_shared<mod_params::RealParameter>(0., nullptr, quantized);
+    auto collection = mod_params::ParameterCollection<double>({real});
+    auto problem = mod_params::ReducedProblem<double>(collection);
+
+    // Given transformed values are only stored if exact
+    problem.set_values_transformed({0.3});
+    CHECK_EQ(real->get_value(), 0.3);
+    CHECK_EQ(real->get_value_transformed(), 0.25);
+    real->set_transformed_exact(true);
+    problem.set_values_transformed({0.3});
+    CHECK_EQ(real->get_value_transformed(), 0.3);
+}
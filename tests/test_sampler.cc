@@ -0,0 +1,130 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lsst/modelfit/parameters/sampler.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+using Distribution = mod_params::ParameterSampler<double>::Distribution;
+
+TEST_CASE("ParameterSampler") {
+    auto transform_log = std::make_shared<mod_params::LogTransform<double>>();
+    auto pos = std::make_shared<mod_params::PositiveParameter>(2., nullptr, transform_log);
+    auto fixed = std::make_shared<mod_params::RealParameter>(-1., nullptr, nullptr, nullptr, true);
+    auto real = std::make_shared<mod_params::RealParameter>(
+            1., std::make_shared<const mod_params::Limits<double>>(0., 3.));
+    auto collection = mod_params::ParameterCollection<double>({pos, fixed, real});
+
+    auto sampler = mod_params::ParameterSampler<double>(collection, 42);
+    CHECK_EQ(sampler.get_n_free(), 2);
+    CHECK_EQ(sampler.get_scale(*pos), INFINITY);
+    CHECK_THROWS_AS(sampler.set_scale(*pos, -1.), std::invalid_argument);
+    CHECK_NE(sampler.str(), "");
+    CHECK_NE(sampler.repr(true), "");
+
+    const size_t n_draws = 1000;
+    std::vector<double> values(2 * n_draws);
+    CHECK_THROWS_AS(sampler.sample(values), std::invalid_argument);
+    // log(pos) has infinite limits and so needs a finite scale
+    CHECK_THROWS_AS(sampler.sample(values, 0, n_draws), std::invalid_argument);
+    sampler.set_scale(*pos, 1.);
+
+    // log(pos) is uniform within one scale of its current value, while the
+    // real parameter has the default infinite scale and is uniform within its limits
+    sampler.sample(values, 0, n_draws);
+    const double log_pos = std::log(2.);
+    double mean_pos = 0, mean_real = 0;
+    for (size_t idx = 0; idx < n_draws; ++idx) {
+        CHECK_GE(values[2 * idx], log_pos - 1.);
+        CHECK_LE(values[2 * idx], log_pos + 1.);
+        CHECK_GE(values[2 * idx + 1], 0.);
+        CHECK_LE(values[2 * idx + 1], 3.);
+        mean_pos += values[2 * idx] / n_draws;
+        mean_real += values[2 * idx + 1] / n_draws;
+    }
+    CHECK_EQ(mean_pos, doctest::Approx(log_pos).epsilon(0.05));
+    CHECK_EQ(mean_real, doctest::Approx(1.5).epsilon(0.05));
+
+    // Draws depend only on the seed, parameter, stream and draw number
+    std::vector<double> single(2);
+    sampler.sample(single, 17);
+    CHECK_EQ(single[0], values[34]);
+    CHECK_EQ(single[1], values[35]);
+    std::vector<double> other(2);
+    sampler.sample(other, 17, 1, 1);
+    CHECK_NE(other[0], single[0]);
+    sampler.set_seed(43);
+    sampler.sample(other, 17);
+    CHECK_NE(other[0], single[0]);
+    sampler.set_seed(42);
+
+    // Streams can be drawn concurrently and reproduce serial draws
+    std::vector<std::vector<double>> streams(4, std::vector<double>(2 * 10));
+    std::vector<std::thread> threads;
+    for (size_t stream = 0; stream < streams.size(); ++stream) {
+        threads.emplace_back([&sampler, &streams, stream]() {
+            sampler.sample(streams[stream], 0, 10, stream);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    CHECK_EQ(std::vector<double>(values.begin(), values.begin() + 20), streams[0]);
+    CHECK_NE(streams[1], streams[0]);
+
+    // Gaussian jitter is reflected back within limits
+    sampler.set_distribution(Distribution::normal);
+    CHECK_EQ(sampler.get_scale(*real), 1.);
+    sampler.set_scale(*real, INFINITY);
+    CHECK_THROWS_AS(sampler.sample(values, 0, n_draws), std::invalid_argument);
+    sampler.set_scale(*real, 2.);
+    sampler.set_scale(*pos, 0.1);
+    sampler.sample(values, 0, n_draws);
+    double var_pos = 0;
+    for (size_t idx = 0; idx < n_draws; ++idx) {
+        CHECK_GE(values[2 * idx + 1], 0.);
+        CHECK_LE(values[2 * idx + 1], 3.);
+        var_pos += (values[2 * idx] - log_pos) * (values[2 * idx] - log_pos) / n_draws;
+    }
+    CHECK_EQ(std::sqrt(var_pos), doctest::Approx(0.1).epsilon(0.1));
+
+    // Jitter is relative to the current values, so draw before setting them
+    sampler.sample(single, 3);
+    sampler.set_sample(3);
+    CHECK_EQ(pos->get_value_transformed(), doctest::Approx(single[0]));
+    CHECK_EQ(real->get_value(), doctest::Approx(single[1]));
+    CHECK_EQ(fixed->get_value(), -1.);
+}
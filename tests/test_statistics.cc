@@ -0,0 +1,108 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define LSST_MODELFIT_PARAMETERS_STATISTICS
+
+#include "doctest.h"
+
+#include <thread>
+
+#include "lsst/modelfit/parameters/statistics.h"
+
+#include "parameters.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+TEST_CASE("ValueStatistics") {
+    mod_params::ValueStatistics<double> stats, stats2;
+    for (double value : {1., 2., 3.}) stats.add(value);
+    for (double value : {-4., 0., std::numeric_limits<double>::infinity()}) stats2.add(value);
+    CHECK_EQ(stats.n, 3);
+    CHECK_EQ(stats.mean, 2.);
+    CHECK_EQ(stats.get_variance(), 1.);
+    CHECK_EQ(stats2.n_nonfinite, 1);
+    CHECK_EQ(stats2.n_zero, 1);
+    stats.merge(stats2);
+    CHECK_EQ(stats.n, 5);
+    CHECK_EQ(stats.min, -4.);
+    CHECK_EQ(stats.max, 3.);
+    CHECK_EQ(stats.mean, doctest::Approx(0.4));
+    CHECK_EQ(stats.get_variance(), doctest::Approx(7.3));
+    auto bin = mod_params::ValueStatistics<double>::get_bin(2.);
+    // 2 and 3 share a bin with BINS_PER_DECADE=4
+    CHECK_EQ(stats.histogram_positive[bin], 2);
+    CHECK_LE(mod_params::ValueStatistics<double>::get_bin_edge(bin), 2.);
+    CHECK_GT(mod_params::ValueStatistics<double>::get_bin_edge(bin + 1), 2.);
+    CHECK_EQ(stats.histogram_negative[mod_params::ValueStatistics<double>::get_bin(-4.)], 1);
+    CHECK_EQ(mod_params::ValueStatistics<double>::get_bin(1e-300), 0);
+    CHECK_GT(stats.str().size(), 0);
+}
+
+TEST_CASE("ValueStatisticsRegistry") {
+    using Registry = mod_params::ValueStatisticsRegistry<double>;
+    Registry::reset();
+    auto real = std::make_shared<mod_params::RealParameter>(0., nullptr, nullptr, nullptr, false, "x");
+    real->set_value(1.);
+    std::thread thread([] {
+        auto real_thread = mod_params::RealParameter(0., nullptr, nullptr, nullptr, false, "x");
+        real_thread.set_value(3.);
+        real_thread.set_label("y");
+        real_thread.set_value(5.);
+    });
+    thread.join();
+
+    auto merged = Registry::merge();
+    const auto& stats_x = merged.at(real->get_name()).at("x");
+    CHECK_EQ(stats_x.n, 2);
+    CHECK_EQ(stats_x.mean, 2.);
+    CHECK_EQ(merged.at(real->get_name()).at("y").n, 1);
+    auto merged_labels = Registry::merge_labels();
+    CHECK_EQ(merged_labels.at(real->get_name()).max, 5.);
+    CHECK_NE(Registry::report().find("\"real\": {\"x\": {\"n\": 2"), std::string::npos);
+    Registry::reset();
+    CHECK_EQ(Registry::merge().size(), 0);
+
+    // Cached statistics locations are invalidated by resets and label changes
+    real->set_value(2.);
+    real->set_label("z");
+    real->set_value(4.);
+    merged = Registry::merge();
+    CHECK_EQ(merged.at(real->get_name()).at("x").n, 1);
+    CHECK_EQ(merged.at(real->get_name()).at("z").mean, 4.);
+    Registry::reset();
+
+    // Setting a whole array records each value stored
+    auto array = std::make_shared<mod_params::PositiveParameterArray>(3, 1., nullptr, nullptr, nullptr, false,
+                                                                      "a");
+    array->set_values({1., 2., 6.});
+    array->set_values_transformed({3., 3., 3.});
+    array->set_value(0, 3.);
+    merged = Registry::merge();
+    const auto& stats_a = merged.at(array->get_element(0)->get_name()).at("a");
+    CHECK_EQ(stats_a.n, 7);
+    CHECK_EQ(stats_a.mean, 3.);
+    CHECK_EQ(stats_a.max, 6.);
+    Registry::reset();
+}
@@ -33,15 +33,40 @@ TEST_CASE("Log10Transform") {
     auto transform = mod_params::Log10Transform<double>();
     CHECK_EQ(transform.forward(1.0), 0.);
     CHECK_LT(std::abs(transform.forward(10.0) - 1.), 1e-12);
+    CHECK_EQ(transform.derivative(10.0), doctest::Approx(0.1 / M_LN10));
+    CHECK_EQ(transform.second_derivative(10.0), doctest::Approx(-0.01 / M_LN10));
+    CHECK_EQ(transform.log_abs_derivative(10.0), doctest::Approx(log(transform.derivative(10.0))));
     CHECK_EQ(transform.repr(), "lsst::modelfit::parameters::Log10Transform<double>()");
     CHECK_EQ(transform.repr(true, "."), "lsst.modelfit.parameters.Log10Transform<double>()");
     CHECK_EQ(transform.str(), "Log10Transform<double>()");
 }
 
+TEST_CASE("LogTransform") {
+    auto transform = mod_params::LogTransform<double>();
+    const double x[3] = {0.5, 1.0, 4.0};
+    double out[3];
+    transform.forward_batch(x, out, 3);
+    transform.reverse_batch(out, out, 3);
+    for (size_t i = 0; i < 3; ++i) CHECK_EQ(out[i], doctest::Approx(x[i]));
+    transform.derivative_batch(x, out, 3);
+    for (size_t i = 0; i < 3; ++i) CHECK_EQ(out[i], transform.derivative(x[i]));
+    transform.log_abs_derivative_batch(x, out, 3);
+    for (size_t i = 0; i < 3; ++i) CHECK_EQ(out[i], doctest::Approx(log(transform.derivative(x[i]))));
+    transform.second_derivative_batch(x, out, 3);
+    for (size_t i = 0; i < 3; ++i) CHECK_EQ(out[i], -1. / (x[i] * x[i]));
+}
+
 TEST_CASE("UnitTransform") {
     auto transform = mod_params::UnitTransform<double>();
     CHECK_EQ(transform.forward(1.), 1.);
     CHECK_EQ(transform.reverse(-1.), -1.);
+    CHECK_EQ(transform.second_derivative(2.), 0.);
+    const double x[2] = {-1., 2.};
+    double out[2];
+    transform.forward_batch(x, out, 2);
+    CHECK_EQ(out[1], 2.);
+    transform.derivative_batch(x, out, 2);
+    CHECK_EQ(out[0], 1.);
     CHECK_EQ(transform.repr(), "lsst::modelfit::parameters::UnitTransform<double>()");
     CHECK_EQ(transform.repr(true, "."), "lsst.modelfit.parameters.UnitTransform<double>()");
     CHECK_EQ(transform.str(), "UnitTransform<double>()");
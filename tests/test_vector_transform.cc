@@ -0,0 +1,211 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of modelfit_parameters.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "lsst/modelfit/parameters/collection.h"
+#include "lsst/modelfit/parameters/vector_transform.h"
+
+#include "parameters.h"
+#include "transforms.h"
+
+namespace mod_params = lsst::modelfit::parameters;
+
+namespace {
+// Check a transform's round trip, Jacobians and log determinant at x
+void check_transform(const mod_params::VectorTransform<double>& transform, const std::vector<double>& x) {
+    const size_t n = transform.size();
+    CHECK_EQ(x.size(), n);
+    std::vector<double> y(n), x_rev(n), jac(n * n), jac_rev(n * n);
+    transform.forward(x.data(), y.data());
+    transform.reverse(y.data(), x_rev.data());
+    for (size_t i = 0; i < n; ++i) CHECK_EQ(x_rev[i], doctest::Approx(x[i]));
+
+    transform.jacobian(x.data(), jac.data());
+    transform.jacobian_reverse(y.data(), jac_rev.data());
+    // The reverse Jacobian must be the inverse of the forward one
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            double sum = 0;
+            for (size_t k = 0; k < n; ++k) sum += jac[row * n + k] * jac_rev[k * n + col];
+            CHECK_EQ(sum, doctest::Approx(row == col).epsilon(1e-10));
+        }
+    }
+    // Compare the forward Jacobian to central finite differences
+    const double step = 1e-7;
+    std::vector<double> x_step = x, y_hi(n), y_lo(n);
+    for (size_t col = 0; col < n; ++col) {
+        x_step[col] = x[col] + step;
+        transform.forward(x_step.data(), y_hi.data());
+        x_step[col] = x[col] - step;
+        transform.forward(x_step.data(), y_lo.data());
+        x_step[col] = x[col];
+        for (size_t row = 0; row < n; ++row) {
+            CHECK_EQ(jac[row * n + col], doctest::Approx((y_hi[row] - y_lo[row]) / (2 * step)).epsilon(1e-6));
+        }
+    }
+    // Determinant by the default (Gauss-Jordan) path via a 2x2/3x3 expansion
+    double det = 0;
+    if (n == 2) {
+        det = jac[0] * jac[3] - jac[1] * jac[2];
+    } else if (n == 3) {
+        det = jac[0] * (jac[4] * jac[8] - jac[5] * jac[7]) - jac[1] * (jac[3] * jac[8] - jac[5] * jac[6])
+              + jac[2] * (jac[3] * jac[7] - jac[4] * jac[6]);
+    }
+    CHECK_EQ(transform.log_abs_det_jacobian(x.data()), doctest::Approx(std::log(std::abs(det))));
+}
+}  // namespace
+
+TEST_CASE("SoftmaxTransform") {
+    const mod_params::SoftmaxTransform<double> transform(2);
+    CHECK_EQ(transform.size(), 2);
+    CHECK_THROWS_AS(mod_params::SoftmaxTransform<double>(0), std::invalid_argument);
+    check_transform(transform, {0.2, 0.5});
+    check_transform(transform, {0.01, 0.9});
+
+    // Any transformed value maps inside the simplex
+    const std::vector<double> y = {30., -30.};
+    std::vector<double> x(2);
+    transform.reverse(y.data(), x.data());
+    CHECK_GT(x[0], 0);
+    CHECK_GT(x[1], 0);
+    CHECK_LT(x[0] + x[1], 1);
+}
+
+TEST_CASE("EllipseTransform") {
+    const mod_params::EllipseTransform<double> transform{};
+    CHECK_EQ(transform.size(), 3);
+    check_transform(transform, {1.5, 0.4, 0.3});
+    check_transform(transform, {0.2, 3.0, -0.9});
+
+    const std::vector<double> y = {-2., 5., 1.};
+    std::vector<double> x(3);
+    transform.reverse(y.data(), x.data());
+    CHECK_GT(x[0], 0);
+    CHECK_GT(x[1], 0);
+    CHECK_LT(std::abs(x[2]), 1);
+}
+
+TEST_CASE("VectorTransform batch") {
+    const mod_params::EllipseTransform<double> transform{};
+    const std::vector<double> x = {1.5, 0.4, 0.3, 0.2, 3.0, -0.9};
+    std::vector<double> y(6), x_rev(6), logdet(2), jac(18);
+    transform.forward_batch(x.data(), y.data(), 2);
+    transform.reverse_batch(y.data(), x_rev.data(), 2);
+    transform.log_abs_det_jacobian_batch(x.data(), logdet.data(), 2);
+    transform.jacobian_batch(x.data(), jac.data(), 2);
+    std::vector<double> y_single(3), jac_single(9);
+    for (size_t i = 0; i < 2; ++i) {
+        transform.forward(&x[3 * i], y_single.data());
+        transform.jacobian(&x[3 * i], jac_single.data());
+        for (size_t k = 0; k < 3; ++k) {
+            CHECK_EQ(y[3 * i + k], y_single[k]);
+            CHECK_EQ(x_rev[3 * i + k], doctest::Approx(x[3 * i + k]));
+        }
+        for (size_t k = 0; k < 9; ++k) CHECK_EQ(jac[9 * i + k], jac_single[k]);
+        CHECK_EQ(logdet[i], transform.log_abs_det_jacobian(&x[3 * i]));
+    }
+}
+
+TEST_CASE("ParameterCollection with VectorTransform") {
+    auto log = std::make_shared<mod_params::LogTransform<double>>();
+    auto other = std::make_shared<mod_params::PositiveParameter>(2., nullptr, log);
+    auto sigma_x = std::make_shared<mod_params::PositiveParameter>(1.5);
+    auto sigma_y = std::make_shared<mod_params::PositiveParameter>(0.4);
+    auto rho = std::make_shared<mod_params::RealParameter>(0.3);
+    auto fixed = std::make_shared<mod_params::RealParameter>(1., nullptr, nullptr, nullptr, true);
+    mod_params::ParameterCollection<double> collection({sigma_x, other, sigma_y, fixed, rho});
+    auto ellipse = std::make_shared<const mod_params::EllipseTransform<double>>();
+
+    CHECK_THROWS_AS(collection.add_vector_transform(ellipse, {sigma_x, sigma_y}), std::invalid_argument);
+    CHECK_THROWS_AS(collection.add_vector_transform(ellipse, {sigma_x, other, rho}), std::invalid_argument);
+    CHECK_THROWS_AS(collection.add_vector_transform(ellipse, {sigma_x, sigma_x, rho}), std::invalid_argument);
+    collection.add_vector_transform(ellipse, {sigma_x, sigma_y, rho});
+    CHECK_EQ(collection.get_vector_transforms().size(), 1);
+    CHECK_THROWS_AS(collection.add_vector_transform(ellipse, {sigma_x, sigma_y, rho}), std::invalid_argument);
+    CHECK_THROWS_AS(collection.tie(rho, *other), std::invalid_argument);
+
+    // Free values are ordered sigma_x, other, sigma_y, rho
+    const std::vector<double> x = {1.5, 0.4, 0.3};
+    std::vector<double> y(3);
+    ellipse->forward(x.data(), y.data());
+    CHECK_EQ(collection.get_n_free(), 4);
+    std::vector<double> values(4);
+    collection.get_values_transformed(values);
+    CHECK_EQ(values[0], doctest::Approx(y[0]));
+    CHECK_EQ(values[1], doctest::Approx(std::log(2.)));
+    CHECK_EQ(values[2], doctest::Approx(y[1]));
+    CHECK_EQ(values[3], doctest::Approx(y[2]));
+
+    CHECK_EQ(collection.log_abs_det_jacobian(),
+             doctest::Approx(ellipse->log_abs_det_jacobian(x.data()) - std::log(2.)));
+    std::vector<double> values_untransformed(4), logdets(1);
+    collection.get_values(values_untransformed);
+    collection.log_abs_det_jacobian(values_untransformed, logdets);
+    CHECK_EQ(logdets[0], doctest::Approx(collection.log_abs_det_jacobian()));
+
+    values = {-1., std::log(3.), 2., 0.5};
+    collection.set_values_transformed(values);
+    CHECK_EQ(other->get_value(), doctest::Approx(3.));
+    const std::vector<double> y_new = {-1., 2., 0.5};
+    std::vector<double> x_new(3);
+    ellipse->reverse(y_new.data(), x_new.data());
+    CHECK_EQ(sigma_x->get_value(), doctest::Approx(x_new[0]));
+    CHECK_EQ(sigma_y->get_value(), doctest::Approx(x_new[1]));
+    CHECK_EQ(rho->get_value(), doctest::Approx(x_new[2]));
+    std::vector<double> values_round(4);
+    collection.get_values_transformed(values_round);
+    for (size_t i = 0; i < 4; ++i) CHECK_EQ(values_round[i], doctest::Approx(values[i]));
+
+    // Gradient chain rule: dL/dy = J_reverse^T dL/dx
+    std::vector<double> gradient = {1., 2., 3., 4.};
+    std::vector<double> jac_rev(9);
+    ellipse->jacobian_reverse(y_new.data(), jac_rev.data());
+    collection.transform_gradient(gradient);
+    CHECK_EQ(gradient[0], doctest::Approx(1. * jac_rev[0] + 3. * jac_rev[3] + 4. * jac_rev[6]));
+    CHECK_EQ(gradient[1], doctest::Approx(2. * 3.));
+    CHECK_EQ(gradient[2], doctest::Approx(1. * jac_rev[1] + 3. * jac_rev[4] + 4. * jac_rev[7]));
+    CHECK_EQ(gradient[3], doctest::Approx(1. * jac_rev[2] + 3. * jac_rev[5] + 4. * jac_rev[8]));
+
+    std::vector<double> hessian(16), diagonal(4);
+    CHECK_THROWS_AS(collection.transform_hessian(hessian, gradient), std::logic_error);
+    CHECK_THROWS_AS(collection.transform_hessian_diagonal(diagonal, gradient), std::logic_error);
+
+    rho->set_free(false);
+    values.resize(3);
+    CHECK_THROWS_AS(collection.get_values_transformed(values), std::logic_error);
+    CHECK_THROWS_AS(collection.get_values_transformed(values), std::logic_error);
+
+    // The group's cached free indices are recomputed when free statuses change
+    rho->set_free(true);
+    other->set_fixed(true);
+    collection.get_values_transformed(values);
+    for (size_t i = 0; i < 3; ++i) CHECK_EQ(values[i], doctest::Approx(y_new[i]));
+}
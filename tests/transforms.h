@@ -44,8 +44,26 @@ public:
     }
 
     inline T derivative(T x) const override { return 1./x; }
+    inline T log_abs_derivative(T x) const override { return -log(x); }
     inline T forward(T x) const override { return log(x); }
     inline T reverse(T x) const override { return exp(x); }
+    inline T second_derivative(T x) const override { return -1./(x*x); }
+
+    void derivative_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = 1./x[i];
+    }
+    void log_abs_derivative_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = -log(x[i]);
+    }
+    void forward_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = log(x[i]);
+    }
+    void reverse_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = exp(x[i]);
+    }
+    void second_derivative_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = -1./(x[i]*x[i]);
+    }
 };
 
 template <typename T>
@@ -61,10 +79,67 @@ public:
         return type_name_str<Log10Transform>(true) + "()";
     }
 
-    inline T derivative(T x) const override { return 1./x; }
+    inline T derivative(T x) const override { return 1./(x*M_LN10); }
+    inline T log_abs_derivative(T x) const override { return -log(x*M_LN10); }
     inline T forward(T x) const override { return log10(x); }
     // pow10 is missing on macos
     inline T reverse(T x) const override { return pow(10.0, x); }
+    inline T second_derivative(T x) const override { return -1./(x*x*M_LN10); }
+
+    void derivative_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = 1./(x[i]*M_LN10);
+    }
+    void log_abs_derivative_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = -log(x[i]*M_LN10);
+    }
+    void forward_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = log10(x[i]);
+    }
+    void reverse_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = pow(10.0, x[i]);
+    }
+    void second_derivative_batch(const T* x, T* out, size_t n) const override {
+        for (size_t i = 0; i < n; ++i) out[i] = -1./(x[i]*x[i]*M_LN10);
+    }
+};
+
+/// A decreasing transform, mapping x to -log(x)
+template <typename T>
+class NegativeLogTransform : public Transform<T> {
+public:
+    std::string description() const override { return "Negative natural logarithmic transform"; }
+    std::string repr(bool = false,
+                     const std::string_view& namespace_separator = Object::CC_NAMESPACE_SEPARATOR
+                     ) const override {
+        return type_name_str<NegativeLogTransform>(false, namespace_separator) + "()";
+    }
+    std::string str() const override {
+        return type_name_str<NegativeLogTransform>(true) + "()";
+    }
+
+    inline T derivative(T x) const override { return -1./x; }
+    inline T forward(T x) const override { return -log(x); }
+    inline T reverse(T x) const override { return exp(-x); }
+    inline T second_derivative(T x) const override { return 1./(x*x); }
+};
+
+/// A unit transform with forward values rounded to multiples of 1/8, i.e. a large round trip error
+template <typename T>
+class QuantizedTransform : public Transform<T> {
+public:
+    std::string description() const override { return "Quantized unit transform"; }
+    std::string repr(bool = false,
+                     const std::string_view& namespace_separator = Object::CC_NAMESPACE_SEPARATOR
+                     ) const override {
+        return type_name_str<QuantizedTransform>(false, namespace_separator) + "()";
+    }
+    std::string str() const override {
+        return type_name_str<QuantizedTransform>(true) + "()";
+    }
+
+    inline T derivative(T) const override { return 1.; }
+    inline T forward(T x) const override { return std::round(x*8)/8; }
+    inline T reverse(T x) const override { return x; }
 };
 }
 